@@ -0,0 +1,12 @@
+#include "encoding_benchmark.h"
+#include "hash_table_benchmark.h"
+#include "kmer256_benchmark.h"
+#include "prefetch_benchmark.h"
+
+int main() {
+    EncodingBenchmark();
+    HashTableBenchmark();
+    KMer256Benchmark();
+    PrefetchBenchmark();
+    return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+/// Prevent the compiler from optimizing away the computation of the value.
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// Run the function the given number of times and return the best time in seconds.
+template <typename F>
+double Measure(F &&function, int repetitions = 3) {
+    double best = 1e100;
+    for (int i = 0; i < repetitions; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/// Print the throughput of the benchmark with the given name.
+void Report(const std::string &name, double items, double seconds, const std::string &unit) {
+    std::cout << "  " << name << ": " << items / seconds / 1e6 << " M" << unit << "/s" << std::endl;
+}
+
+/// Return a random nucleotide sequence of the given length where the given fraction of characters is 'N'.
+std::string RandomSequence(size_t length, double nFraction = 0.0, unsigned seed = 42) {
+    std::mt19937_64 generator(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::string sequence(length, 'A');
+    for (auto &&c : sequence) c = uniform(generator) < nFraction ? 'N' : "ACGT"[generator() & 3];
+    return sequence;
+}
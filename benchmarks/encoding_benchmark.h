@@ -0,0 +1,71 @@
+#pragma once
+#include "../src/ac/kmers_ac.h"
+#include "../src/parser.h"
+#include "../src/encoding.h"
+
+#include "benchmark.h"
+
+/// The per-character k-mer rolling loop as it was before the encoding kernel.
+template <typename kmer_t, typename F>
+void ForEachKMerTableLookup([[maybe_unused]] kmer_t _, size_t sequence_length, const char* sequence, int64_t k,
+                            bool complements, bool case_sensitive, F &&callback) {
+    int64_t currentLength = 0;
+    kmer_t currentKMer = 0, reverseComplement = 0;
+    kmer_t cases = 0;
+    kmer_t mask = (((kmer_t) 1) <<  (2 * k) ) - 1;
+    kmer_t shift = 2 * (k - 1);
+    for (size_t i = 0; i < sequence_length; ++i) {
+        auto data = nucleotideToInt[(uint8_t)sequence[i]];
+        if (data >= 4) {
+            currentKMer = reverseComplement = 0;
+            currentLength = 0;
+            continue;
+        }
+        currentKMer = ((currentKMer << 2) | data) & mask;
+        reverseComplement = (reverseComplement >> 2) | ((kmer_t(3 ^ data)) << shift);
+        cases = (cases | (!case_sensitive || sequence[i] <= 'Z')) << 1;
+        if ((++currentLength >= k) && (cases & (kmer_t(1) << k))) {
+            kmer_t canonical = ((!complements) || currentKMer < reverseComplement) ? currentKMer : reverseComplement;
+            callback(canonical);
+        }
+    }
+}
+
+template <typename kmer_t>
+void RollingBenchmark(const std::string &sequence, int k) {
+    kmer_t sink = 0;
+    double before = Measure([&] {
+        ForEachKMerTableLookup(kmer_t(0), sequence.size(), sequence.data(), k, true, false, [&](kmer_t kMer) { sink ^= kMer; });
+    });
+    double after = Measure([&] {
+        RollingKMer<kmer_t> state;
+        ForEachKMer(state, sequence.size(), sequence.data(), k, true, false, [&](kmer_t kMer) { sink ^= kMer; });
+    });
+    DoNotOptimize(sink);
+    Report("k=" + std::to_string(k) + " rolling loop, table lookup", sequence.size(), before, "bases");
+    Report("k=" + std::to_string(k) + " rolling loop, encoding kernel", sequence.size(), after, "bases");
+}
+
+void EncodingBenchmark() {
+    std::cout << "Nucleotide encoding" << std::endl;
+    auto sequence = RandomSequence(size_t(1) << 26, 0.001);
+    uint8_t codes[ENCODING_BLOCK_SIZE];
+    uint64_t sink = 0;
+    double scalar = Measure([&] {
+        for (size_t i = 0; i + ENCODING_BLOCK_SIZE <= sequence.size(); i += ENCODING_BLOCK_SIZE) {
+            uint64_t lowercase;
+            sink ^= EncodeNucleotidesScalar(sequence.data() + i, ENCODING_BLOCK_SIZE, codes, lowercase) ^ codes[i & 63];
+        }
+    });
+    double simd = Measure([&] {
+        for (size_t i = 0; i + ENCODING_BLOCK_SIZE <= sequence.size(); i += ENCODING_BLOCK_SIZE) {
+            uint64_t lowercase;
+            sink ^= EncodeNucleotides(sequence.data() + i, ENCODING_BLOCK_SIZE, codes, lowercase) ^ codes[i & 63];
+        }
+    });
+    DoNotOptimize(sink);
+    Report("kernel, table lookup", sequence.size(), scalar, "bases");
+    Report("kernel, SIMD", sequence.size(), simd, "bases");
+    RollingBenchmark<kmer64_t>(sequence, 31);
+    RollingBenchmark<kmer128_t>(sequence, 63);
+}
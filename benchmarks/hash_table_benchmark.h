@@ -0,0 +1,55 @@
+#pragma once
+#include "../src/ac/kmers_ac.h"
+#include "../src/parser.h"
+#include "../src/global.h"
+#include "../src/local.h"
+#include "../src/swiss_table.h"
+
+#include <sstream>
+
+#include "benchmark.h"
+
+/// Time the overlap search of global, which mostly looks up the prefixes map.
+template <typename kmer_t, typename kh_wrapper_t>
+double GlobalTrace(kh_wrapper_t wrapper, const std::vector<kmer_t> &kMers, int k) {
+    return Measure([&] {
+        auto copy = kMers;
+        auto path = OverlapHamiltonianPath(wrapper, copy, k, true);
+        DoNotOptimize(path.second[0]);
+    });
+}
+
+/// Time local, which mostly looks up and erases k-mers from the set.
+template <typename kmer_t, typename kh_wrapper_t>
+double LocalTrace(kh_wrapper_t wrapper, const std::vector<kmer_t> &kMers, int k) {
+    return Measure([&] {
+        auto *set = wrapper.kh_init_set();
+        int ret;
+        for (auto &&kMer : kMers) wrapper.kh_put_to_set(set, kMer, &ret);
+        std::stringstream of;
+        Local(set, wrapper, kmer_t(0), of, k, 5, true);
+        wrapper.kh_destroy_set(set);
+        DoNotOptimize(of.str().size());
+    });
+}
+
+template <typename kmer_t, typename kh_wrapper_t>
+void HashTableBenchmark(kh_wrapper_t wrapper, const std::string &sequence, int k) {
+    auto *set = wrapper.kh_init_set();
+    AddKMers(set, wrapper, kmer_t(0), sequence.size(), sequence.data(), k, true);
+    auto kMers = kMersToVec(set, kmer_t(0));
+    wrapper.kh_destroy_set(set);
+    std::string name = "k=" + std::to_string(k) + " ";
+    Report(name + "global, khash", kMers.size(), GlobalTrace(wrapper, kMers, k), "k-mers");
+    Report(name + "global, Swiss table", kMers.size(), GlobalTrace(swiss_dict_t<kmer_t>(), kMers, k), "k-mers");
+    Report(name + "local, khash", kMers.size(), LocalTrace(wrapper, kMers, k), "k-mers");
+    Report(name + "local, Swiss table", kMers.size(), LocalTrace(swiss_dict_t<kmer_t>(), kMers, k), "k-mers");
+}
+
+void HashTableBenchmark() {
+    std::cout << "Hash tables" << std::endl;
+    auto sequence = RandomSequence(size_t(1) << 21);
+    HashTableBenchmark<kmer64_t>(kmer_dict64_t(), sequence, 31);
+    HashTableBenchmark<kmer128_t>(kmer_dict128_t(), sequence, 63);
+    HashTableBenchmark<kmer256_t>(kmer_dict256_t(), sequence, 127);
+}
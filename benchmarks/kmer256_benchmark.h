@@ -0,0 +1,42 @@
+#pragma once
+#include "../src/ac/kmers_ac.h"
+#include "../src/kmers.h"
+#include "../src/khash_utils.h"
+#include "../src/uint256_t/uint256_t.h"
+
+#include "benchmark.h"
+
+/// Reverse complement of the general 256-bit integers, as used before kmer256_t.
+inline uint256_t word_reverse_complement(uint256_t w) {
+    return uint256_t(word_reverse_complement(w.lower()), word_reverse_complement(w.upper()));
+}
+
+/// Time the rolling k-mer loop of AddKMers: shift in a nucleotide, mask, take the canonical k-mer and hash it.
+template <typename kmer_t, typename hash_t>
+double RollingTrace(const std::string &sequence, int k, hash_t hash) {
+    return Measure([&] {
+        kmer_t mask = (kmer_t(1) << (2 * k)) - kmer_t(1), kMer(0);
+        uint64_t hashes = 0;
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            kMer = ((kMer << 2) | kmer_t(nucleotideToInt[(uint8_t)sequence[i]])) & mask;
+            kmer_t reverseComplement = ReverseComplement(kMer, k);
+            hashes ^= hash(kMer < reverseComplement ? kMer : reverseComplement);
+            hashes ^= uint64_t(BitSuffix(kMer, k - 1) ^ BitPrefix(kMer, k, k - 1));
+        }
+        DoNotOptimize(hashes);
+    });
+}
+
+void KMer256Benchmark() {
+    std::cout << "256-bit k-mers" << std::endl;
+    auto sequence = RandomSequence(size_t(1) << 22);
+    Report("k=63 __uint128_t", sequence.size(), RollingTrace<kmer128_t>(sequence, 63, [](kmer128_t kMer) {
+        return kh_int128_hash_func(kMer);
+    }), "k-mers");
+    Report("k=127 uint256_t", sequence.size(), RollingTrace<uint256_t>(sequence, 127, [](uint256_t kMer) {
+        return kh_int128_hash_func((__uint128_t)((kMer >> 129) ^ kMer ^ (kMer << 35)));
+    }), "k-mers");
+    Report("k=127 kmer256_t", sequence.size(), RollingTrace<kmer256_t>(sequence, 127, [](kmer256_t kMer) {
+        return kh_int256_hash_func(kMer);
+    }), "k-mers");
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "../src/ac/kmers_ac.h"
+#include "../src/encoding.h"
+#include "../src/khash_utils.h"
+#include "../src/swiss_table.h"
+
+#include "benchmark.h"
+
+/// Time looking up the keys in the set one by one.
+template <typename kmer_t, typename kh_wrapper_t, typename kh_S_t>
+double LookupTrace(kh_wrapper_t wrapper, kh_S_t *set, const std::vector<kmer_t> &keys) {
+    return Measure([&] {
+        size_t found = 0;
+        for (auto &&key : keys) found += wrapper.kh_get_from_set(set, key) != kh_end(set);
+        DoNotOptimize(found);
+    });
+}
+
+/// Time looking up the keys in the set in blocks whose buckets are prefetched first, as OptimizeOnes does.
+template <typename kmer_t, typename kh_wrapper_t, typename kh_S_t>
+double PrefetchedLookupTrace(kh_wrapper_t wrapper, kh_S_t *set, const std::vector<kmer_t> &keys) {
+    return Measure([&] {
+        size_t found = 0;
+        for (size_t blockStart = 0; blockStart < keys.size(); blockStart += ENCODING_BLOCK_SIZE) {
+            size_t blockEnd = std::min(keys.size(), blockStart + ENCODING_BLOCK_SIZE);
+            for (size_t i = blockStart; i < blockEnd; ++i) wrapper.kh_prefetch_set(set, keys[i]);
+            for (size_t i = blockStart; i < blockEnd; ++i) found += wrapper.kh_get_from_set(set, keys[i]) != kh_end(set);
+        }
+        DoNotOptimize(found);
+    });
+}
+
+template <typename kmer_t, typename kh_wrapper_t>
+void PrefetchBenchmark(kh_wrapper_t wrapper, const std::string &name, size_t count) {
+    auto *set = wrapper.kh_init_set();
+    wrapper.kh_resize_set(set, count * 100 / 77 + 1);
+    std::vector<kmer_t> keys(count);
+    for (size_t i = 0; i < count; ++i) {
+        int ret;
+        keys[i] = kmer_t(MixHash(i));
+        // Only every other looked up key is present.
+        if (i % 2) wrapper.kh_put_to_set(set, keys[i], &ret);
+    }
+    Report(name + ", one by one", count, LookupTrace(wrapper, set, keys), "lookups");
+    Report(name + ", prefetched", count, PrefetchedLookupTrace(wrapper, set, keys), "lookups");
+    wrapper.kh_destroy_set(set);
+}
+
+void PrefetchBenchmark() {
+    std::cout << "Prefetched lookups" << std::endl;
+    for (size_t count : {size_t(1) << 16, size_t(1) << 25}) {
+        std::string name = std::to_string(count >> 1) + " k-mers";
+        PrefetchBenchmark<kmer64_t>(kmer_dict64_t(), name + ", khash", count);
+        PrefetchBenchmark<kmer64_t>(swiss_dict_t<kmer64_t>(), name + ", Swiss table", count);
+    }
+}
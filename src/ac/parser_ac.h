@@ -15,14 +15,11 @@ struct FastaRecord {
 
 /// Read fasta file with given path.
 std::vector<FastaRecord> ReadFasta(std::string &path) {
-    gzFile fp;
+    InputFile *fp;
     kseq_t *seq;
     std::vector<FastaRecord> records;
 
-    fp = gzopen(path.c_str(), "r");
-    if (fp == nullptr) {
-        throw std::invalid_argument("couldn't open file " + path);
-    }
+    fp = OpenFile(path);
     seq = kseq_init(fp);
     while (kseq_read(seq) >= 0) {
         records.push_back(FastaRecord{
@@ -31,7 +28,7 @@ std::vector<FastaRecord> ReadFasta(std::string &path) {
         });
     }
     kseq_destroy(seq);
-    gzclose(fp);
+    CloseFile(fp);
     return records;
 }
 
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <zlib.h>
+
+#include "parallel.h"
+
+/// The size of one buffer filled by the reader thread.
+constexpr size_t ASYNC_BUFFER_SIZE = 1 << 20;
+/// The number of buffers in the ring shared by the reader thread and the consumer.
+constexpr size_t ASYNC_BUFFERS_COUNT = 4;
+
+/// Reader which reads and decompresses the file on a separate thread so that I/O overlaps with the computation.
+/// The reader thread fills a ring of buffers which Read then returns in order and hands back for reuse.
+/// Similarly to gzdopen, the reader takes ownership of the file.
+class AsyncReader {
+public:
+    explicit AsyncReader(gzFile gz) : gz(gz), filled(ASYNC_BUFFERS_COUNT), empty(ASYNC_BUFFERS_COUNT) {
+        for (size_t i = 0; i < ASYNC_BUFFERS_COUNT; ++i) empty.Push(Buffer{std::vector<char>(ASYNC_BUFFER_SIZE), 0});
+        reader = std::thread(&AsyncReader::FillBuffers, this);
+    }
+
+    ~AsyncReader() {
+        empty.Close();
+        reader.join();
+        gzclose(gz);
+    }
+
+    /// Copy up to length decompressed bytes to buffer.
+    /// Return the number of bytes copied, 0 at the end of file or -1 on error.
+    int Read(void *buffer, int length) {
+        int copied = 0;
+        while (copied < length) {
+            if (position == size_t(current.size)) {
+                if (finished) break;
+                if (!current.data.empty()) empty.Push(std::move(current));
+                if (!filled.Pop(current) || current.size <= 0) {
+                    error = current.size < 0;
+                    finished = true;
+                    current.size = 0;
+                }
+                position = 0;
+                continue;
+            }
+            size_t toCopy = std::min(current.size - position, size_t(length - copied));
+            memcpy((char*)buffer + copied, current.data.data() + position, toCopy);
+            position += toCopy;
+            copied += toCopy;
+        }
+        return (copied == 0 && error) ? -1 : copied;
+    }
+
+    /// Return the number of bytes of the underlying, possibly compressed, file which were consumed
+    /// to decompress the current buffer, i.e. the data returned by Read so far and the rest of its buffer.
+    long CompressedOffset() const {
+        return current.offset;
+    }
+
+private:
+    struct Buffer {
+        std::vector<char> data;
+        int size;
+        long offset = 0;
+    };
+
+    /// Fill the empty buffers until the end of the file or an error, which is passed on as the last buffer.
+    void FillBuffers() {
+        Buffer buffer;
+        while (empty.Pop(buffer)) {
+            buffer.size = gzread(gz, buffer.data.data(), buffer.data.size());
+            buffer.offset = gzoffset(gz);
+            bool last = buffer.size <= 0;
+            filled.Push(std::move(buffer));
+            if (last) break;
+        }
+        filled.Close();
+    }
+
+    gzFile gz;
+    // Each queue can hold all the buffers, so pushing never blocks.
+    BlockingQueue<Buffer> filled, empty;
+    std::thread reader;
+
+    // Accessed only by the consumer.
+    Buffer current{std::vector<char>(), 0};
+    size_t position = 0;
+    bool finished = false;
+    bool error = false;
+};
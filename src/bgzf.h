@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+#include <unistd.h>
+#include <zlib.h>
+
+#include "parallel.h"
+
+/// The size of the fixed part of the gzip header.
+constexpr size_t GZIP_HEADER_SIZE = 12;
+/// The size of the gzip footer (CRC32 and ISIZE).
+constexpr size_t GZIP_FOOTER_SIZE = 8;
+/// The number of decompressed blocks a single thread is allowed to be ahead of the consumer.
+constexpr size_t BGZF_BLOCKS_AHEAD_PER_THREAD = 8;
+
+/// Return the total size of the BGZF block with the given header or 0 if it is not a BGZF header.
+/// The header needs to contain at least GZIP_HEADER_SIZE + xlen bytes, where xlen is stored in bytes 10 and 11.
+inline size_t BgzfBlockSize(const uint8_t *header, size_t length) {
+    if (length < GZIP_HEADER_SIZE || header[0] != 31 || header[1] != 139 || header[2] != 8 || !(header[3] & 4)) return 0;
+    size_t xlen = header[10] | (header[11] << 8);
+    if (length < GZIP_HEADER_SIZE + xlen) return 0;
+    // Find the BC subfield containing the block size.
+    for (size_t i = GZIP_HEADER_SIZE; i + 4 <= GZIP_HEADER_SIZE + xlen;) {
+        size_t subfieldLength = header[i + 2] | (header[i + 3] << 8);
+        if (header[i] == 'B' && header[i + 1] == 'C' && subfieldLength == 2 && i + 6 <= GZIP_HEADER_SIZE + xlen) {
+            return (header[i + 4] | (header[i + 5] << 8)) + 1;
+        }
+        i += 4 + subfieldLength;
+    }
+    return 0;
+}
+
+/// Determine whether the file with the given descriptor is BGZF-compressed without changing its offset.
+/// Return false for non-seekable files such as pipes.
+inline bool IsBgzf(int fd) {
+    uint8_t header[GZIP_HEADER_SIZE + 6];
+    ssize_t length = pread(fd, header, sizeof(header), 0);
+    return length > 0 && BgzfBlockSize(header, length) != 0;
+}
+
+/// Decompress a single BGZF block into output and verify its checksum.
+/// Return false if the block is corrupted.
+inline bool InflateBgzfBlock(const std::vector<uint8_t> &block, std::vector<uint8_t> &output) {
+    size_t xlen = block[10] | (block[11] << 8);
+    const uint8_t *footer = block.data() + block.size() - GZIP_FOOTER_SIZE;
+    uint32_t crc = footer[0] | (footer[1] << 8) | (footer[2] << 16) | ((uint32_t)footer[3] << 24);
+    uint32_t size = footer[4] | (footer[5] << 8) | (footer[6] << 16) | ((uint32_t)footer[7] << 24);
+    output.resize(size);
+    z_stream stream;
+    memset(&stream, 0, sizeof(stream));
+    // Negative window bits mean raw deflate data without the gzip header.
+    if (inflateInit2(&stream, -15) != Z_OK) return false;
+    stream.next_in = (Bytef*)block.data() + GZIP_HEADER_SIZE + xlen;
+    stream.avail_in = block.size() - GZIP_HEADER_SIZE - xlen - GZIP_FOOTER_SIZE;
+    // The end-of-file block is empty, but zlib still needs a valid output pointer.
+    uint8_t empty;
+    stream.next_out = size ? output.data() : &empty;
+    stream.avail_out = size;
+    int ret = inflate(&stream, Z_FINISH);
+    inflateEnd(&stream);
+    if (ret != Z_STREAM_END || stream.total_out != size) return false;
+    return crc32(crc32(0L, Z_NULL, 0), output.data(), size) == crc;
+}
+
+/// Reader of BGZF files which decompresses the independent blocks on several threads.
+/// One thread reads the compressed blocks, the workers inflate them and Read returns the data in the original order.
+/// Similarly to gzdopen, the reader takes ownership of the file descriptor.
+class BgzfReader {
+public:
+    BgzfReader(int fd, int threads) : fd(fd), jobs(2 * threads), window(BGZF_BLOCKS_AHEAD_PER_THREAD * threads) {
+        reader = std::thread(&BgzfReader::ReadBlocks, this);
+        for (int t = 0; t < threads; ++t) workers.emplace_back(&BgzfReader::InflateBlocks, this);
+    }
+
+    ~BgzfReader() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+            progress.notify_all();
+        }
+        reader.join();
+        for (auto &&worker : workers) worker.join();
+        close(fd);
+    }
+
+    /// Copy up to length decompressed bytes to buffer.
+    /// Return the number of bytes copied, 0 at the end of file or -1 on error.
+    int Read(void *buffer, int length) {
+        int copied = 0;
+        while (copied < length) {
+            if (position == current.size()) {
+                if (!NextBlock()) break;
+                continue;
+            }
+            size_t toCopy = std::min(current.size() - position, size_t(length - copied));
+            memcpy((uint8_t*)buffer + copied, current.data() + position, toCopy);
+            position += toCopy;
+            copied += toCopy;
+        }
+        return (copied == 0 && error) ? -1 : copied;
+    }
+
+private:
+    struct Block {
+        size_t index;
+        std::vector<uint8_t> data;
+    };
+
+    /// Move to the next decompressed block. Return false if there is none.
+    bool NextBlock() {
+        std::unique_lock<std::mutex> lock(mutex);
+        progress.wait(lock, [&] { return done.count(consumed) || (finished && consumed == blocksCount) || failed; });
+        if (failed) error = true;
+        if (failed || !done.count(consumed)) return false;
+        current = std::move(done[consumed]);
+        done.erase(consumed++);
+        position = 0;
+        progress.notify_all();
+        return true;
+    }
+
+    /// Read the compressed blocks sequentially and pass them to the workers.
+    void ReadBlocks() {
+        size_t index = 0;
+        bool ok = true;
+        while (true) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopped) break;
+            }
+            Block block{index, std::vector<uint8_t>(GZIP_HEADER_SIZE)};
+            ssize_t length = ReadFully(block.data.data(), GZIP_HEADER_SIZE);
+            if (length == 0) break;
+            if (length != (ssize_t)GZIP_HEADER_SIZE) { ok = false; break; }
+            size_t xlen = block.data[10] | (block.data[11] << 8);
+            block.data.resize(GZIP_HEADER_SIZE + xlen);
+            if (ReadFully(block.data.data() + GZIP_HEADER_SIZE, xlen) != (ssize_t)xlen) { ok = false; break; }
+            size_t size = BgzfBlockSize(block.data.data(), block.data.size());
+            if (size < GZIP_HEADER_SIZE + xlen + GZIP_FOOTER_SIZE) { ok = false; break; }
+            block.data.resize(size);
+            size_t rest = size - GZIP_HEADER_SIZE - xlen;
+            if (ReadFully(block.data.data() + GZIP_HEADER_SIZE + xlen, rest) != (ssize_t)rest) { ok = false; break; }
+            jobs.Push(std::move(block));
+            ++index;
+        }
+        jobs.Close();
+        std::lock_guard<std::mutex> lock(mutex);
+        blocksCount = index;
+        finished = true;
+        failed = failed || !ok;
+        progress.notify_all();
+    }
+
+    /// Inflate the blocks without getting more than window blocks ahead of the consumer.
+    void InflateBlocks() {
+        Block block;
+        while (jobs.Pop(block)) {
+            std::vector<uint8_t> output;
+            bool ok = InflateBgzfBlock(block.data, output);
+            std::unique_lock<std::mutex> lock(mutex);
+            progress.wait(lock, [&] { return block.index < consumed + window || stopped; });
+            if (!ok) failed = true;
+            done[block.index] = std::move(output);
+            progress.notify_all();
+        }
+    }
+
+    /// Read exactly length bytes unless the end of file is reached.
+    ssize_t ReadFully(uint8_t *buffer, size_t length) {
+        size_t total = 0;
+        while (total < length) {
+            ssize_t got = read(fd, buffer + total, length - total);
+            if (got < 0) return -1;
+            if (got == 0) break;
+            total += got;
+        }
+        return total;
+    }
+
+    int fd;
+    BlockingQueue<Block> jobs;
+    size_t window;
+    std::thread reader;
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable progress;
+    std::map<size_t, std::vector<uint8_t>> done;
+    size_t consumed = 0;
+    size_t blocksCount = 0;
+    bool finished = false;
+    bool failed = false;
+    bool stopped = false;
+
+    // Accessed only by the consumer.
+    std::vector<uint8_t> current;
+    size_t position = 0;
+    bool error = false;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <vector>
+
+/// The number of bits set for each inserted element.
+constexpr int BLOOM_HASHES = 4;
+
+/// Bloom filter in which all the bits of an element lie in a single cache line.
+/// This costs a slightly higher false positive rate than a standard Bloom filter of the same size,
+/// but each query touches only one cache line.
+class BlockedBloomFilter {
+public:
+    /// Create an empty filter which occupies about the given number of bytes.
+    explicit BlockedBloomFilter(size_t bytes) : blocks(std::max(bytes / sizeof(Block), size_t(1))) {}
+
+    /// Insert the element with the given 64-bit hash.
+    /// Return whether it was already present or the filter gave a false positive.
+    bool Insert(uint64_t hash) {
+        Block &block = blocks[BlockIndex(hash)];
+        bool present = true;
+        for (int i = 0; i < BLOOM_HASHES; ++i) {
+            int bit = BitIndex(hash, i);
+            uint64_t mask = uint64_t(1) << (bit & 63);
+            present &= (block.words[bit >> 6] & mask) != 0;
+            block.words[bit >> 6] |= mask;
+        }
+        return present;
+    }
+
+    /// Determine whether the element with the given 64-bit hash may be present.
+    bool Contains(uint64_t hash) const {
+        const Block &block = blocks[BlockIndex(hash)];
+        for (int i = 0; i < BLOOM_HASHES; ++i) {
+            int bit = BitIndex(hash, i);
+            if (!(block.words[bit >> 6] & (uint64_t(1) << (bit & 63)))) return false;
+        }
+        return true;
+    }
+
+    /// Return the size of the filter in bytes.
+    size_t Size() const {
+        return blocks.size() * sizeof(Block);
+    }
+
+private:
+    struct alignas(64) Block {
+        uint64_t words[8] = {};
+    };
+
+    /// Map the hash uniformly to a block without a division.
+    size_t BlockIndex(uint64_t hash) const {
+        return (size_t)(((__uint128_t)hash * blocks.size()) >> 64);
+    }
+
+    /// Return the i-th bit of the element within its block.
+    /// The bits are taken from a multiplied hash so that they are independent of the block index.
+    static int BitIndex(uint64_t hash, int i) {
+        return ((hash * 0x9E3779B97F4A7C15ULL) >> (9 * i + 16)) & 511;
+    }
+
+    std::vector<Block> blocks;
+};
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// The first bytes of both files of a global checkpoint.
+constexpr char CHECKPOINT_MAGIC[8] = {'K', 'M', 'C', 'A', 'M', 'C', 'P', '2'};
+/// The number of records or k-mers written or read at once.
+constexpr size_t CHECKPOINT_BUFFER_SIZE = 1 << 16;
+/// The first value of the record which marks the end of an overlap in the edge log.
+constexpr uint64_t CHECKPOINT_LEVEL_END = UINT64_MAX;
+
+/// The header of the checkpoint files. In kmers.bin, it is followed by count k-mers of width bytes each
+/// in the order in which global processes them. In edges.bin, it is followed by the records of the added edges.
+struct CheckpointHeader {
+    char magic[8];
+    uint32_t k;
+    uint32_t memoryReductionFactor;
+    uint8_t complements;
+    uint8_t width;
+    uint8_t lowerBound;
+    uint8_t reserved[5];
+    uint64_t count;
+    uint64_t maxMemory;
+};
+static_assert(sizeof(CheckpointHeader) == 40, "The checkpoint header must not contain padding.");
+
+/// Checkpoint of a run of global in a directory, from which an interrupted run can be resumed.
+/// The k-mers are saved once and the edges which global adds are appended to a log, with a record
+/// which marks the end of each overlap. Replaying the edges of the finished overlaps restores all the arrays of global.
+/// Both files are written sequentially by background threads so that global does not wait for the disk.
+class GlobalCheckpoint {
+public:
+    /// Create the checkpoint in the given directory, which is created if needed.
+    /// If resume is set, the state saved there is loaded instead.
+    GlobalCheckpoint(std::string dir, bool resume) : dir(std::move(dir)), resume(resume) {
+        std::error_code error;
+        if (!resume) std::filesystem::create_directories(this->dir, error);
+    }
+
+    ~GlobalCheckpoint() {
+        Wait();
+    }
+
+    /// Return the memory reduction factor of the run whose k-mers were loaded.
+    int MemoryReductionFactor() const {
+        return memoryReductionFactor;
+    }
+
+    /// Save the k-mers in their current order in the background; they must not change until Wait is called.
+    /// The k-mers are either a std::vector or a PackedKMerArray.
+    /// The memory reduction factor and the memory limit, which determine the batches of global, are saved with them.
+    template <typename kmers_t>
+    void SaveKMers(const kmers_t &kMers, int k, bool complements, bool lowerBound, int memoryReductionFactor, size_t maxMemory) {
+        typedef typename kmers_t::value_type kmer_t;
+        // Remove the k-mers of a previous run first, so that they are never resumed with the edges of this run.
+        std::remove(KMersPath().c_str());
+        kMersWriter = std::thread([this, &kMers, k, complements, lowerBound, memoryReductionFactor, maxMemory] {
+            std::string tmpPath = KMersPath() + ".tmp";
+            std::ofstream of(tmpPath, std::ios::binary);
+            auto header = Header(k, complements, lowerBound, kMers.size());
+            header.memoryReductionFactor = memoryReductionFactor;
+            header.maxMemory = maxMemory;
+            header.width = sizeof(kmer_t);
+            of.write((const char*)&header, sizeof(header));
+            std::vector<kmer_t> buffer;
+            buffer.reserve(CHECKPOINT_BUFFER_SIZE);
+            for (size_t i = 0; i < kMers.size(); ++i) {
+                buffer.push_back(kMers[i]);
+                if (buffer.size() == CHECKPOINT_BUFFER_SIZE || i + 1 == kMers.size()) {
+                    of.write((const char*)buffer.data(), buffer.size() * sizeof(kmer_t));
+                    buffer.clear();
+                }
+            }
+            of.close();
+            // Rename the complete file so that an interrupted write does not leave a truncated k-mer file.
+            if (!of || std::rename(tmpPath.c_str(), KMersPath().c_str())) Fail();
+        });
+    }
+
+    /// Load the saved k-mers and return whether they were saved with the given k, complements, lowerBound and maxMemory
+    /// and the edge log, if any, was written for them.
+    template <typename kmer_t>
+    bool LoadKMers(std::vector<kmer_t> &kMers, int k, bool complements, bool lowerBound, size_t maxMemory) {
+        std::ifstream in(KMersPath(), std::ios::binary);
+        CheckpointHeader header;
+        if (!ReadHeader(in, header) || (int)header.k != k || (bool)header.complements != complements
+            || (bool)header.lowerBound != lowerBound || header.maxMemory != maxMemory || header.width != sizeof(kmer_t)) return false;
+        kMers.resize(header.count);
+        if (!in.read((char*)kMers.data(), header.count * sizeof(kmer_t))) return false;
+        // The edges are replayed on the loaded k-mers, so a log of another run must not be resumed.
+        std::ifstream log(EdgesPath(), std::ios::binary);
+        CheckpointHeader logHeader;
+        if (ReadHeader(log, logHeader) && !Matches(logHeader, header.count, k, complements, lowerBound)) return false;
+        memoryReductionFactor = header.memoryReductionFactor;
+        return true;
+    }
+
+    /// Open the log of the edges added by global for n k-mers and return the last finished overlap, or k if none is finished.
+    /// When resuming, the edges of the finished overlaps are first passed to addEdge(i, j, d) in the order
+    /// in which they were added and the edges of the unfinished overlap are dropped from the log.
+    /// A log written for other k-mers, which LoadKMers rejects, is started anew.
+    template <typename add_edge_t>
+    int OpenEdgeLog(size_t n, int k, bool complements, bool lowerBound, add_edge_t addEdge) {
+        int last = k;
+        std::ifstream in;
+        if (resume) in.open(EdgesPath(), std::ios::binary);
+        CheckpointHeader header;
+        if (resume && ReadHeader(in, header) && Matches(header, n, k, complements, lowerBound)) {
+            // First find the end of the last finished overlap, so that only the finished overlaps are replayed.
+            size_t finished = 0;
+            ForEachRecord(in, [&](size_t index, uint64_t i, uint64_t d) {
+                if (i != CHECKPOINT_LEVEL_END) return;
+                finished = index + 1;
+                last = d;
+            });
+            in.clear();
+            in.seekg(sizeof(header));
+            int d = k - 1;
+            ForEachRecord(in, [&](size_t index, uint64_t i, uint64_t j) {
+                if (index >= finished) return;
+                if (i == CHECKPOINT_LEVEL_END) d = int(j) - 1;
+                else addEdge(i, j, d);
+            });
+            in.close();
+            std::filesystem::resize_file(EdgesPath(), sizeof(header) + finished * sizeof(record_t));
+            log.open(EdgesPath(), std::ios::binary | std::ios::app);
+        } else {
+            in.close();
+            log.open(EdgesPath(), std::ios::binary | std::ios::trunc);
+            auto header = Header(k, complements, lowerBound, n);
+            log.write((const char*)&header, sizeof(header));
+            log.flush();
+        }
+        if (!log) Fail();
+        return last;
+    }
+
+    /// Record the edge from the k-mer i to the k-mer j; it is written by the next call of WriteEdges.
+    void AddEdge(size_t i, size_t j) {
+        edges.emplace_back(i, j);
+    }
+
+    /// Write the recorded edges in the background after the previous ones are written.
+    void WriteEdges() {
+        if (edges.empty()) return;
+        if (edgesWriter.joinable()) edgesWriter.join();
+        pending.swap(edges);
+        edges.clear();
+        edgesWriter = std::thread([this] {
+            log.write((const char*)pending.data(), pending.size() * sizeof(record_t));
+            log.flush();
+            if (!log) Fail();
+        });
+    }
+
+    /// Write the recorded edges and mark the overlap d as finished.
+    void FinishLevel(int d) {
+        edges.emplace_back(CHECKPOINT_LEVEL_END, d);
+        // The overlap can be resumed only once the k-mers are saved.
+        if (kMersWriter.joinable()) kMersWriter.join();
+        WriteEdges();
+    }
+
+    /// Wait until everything is written.
+    void Wait() {
+        if (kMersWriter.joinable()) kMersWriter.join();
+        if (edgesWriter.joinable()) edgesWriter.join();
+    }
+
+private:
+    typedef std::pair<uint64_t, uint64_t> record_t;
+
+    std::string KMersPath() const {
+        return dir + "/kmers.bin";
+    }
+
+    std::string EdgesPath() const {
+        return dir + "/edges.bin";
+    }
+
+    static CheckpointHeader Header(int k, bool complements, bool lowerBound, size_t count) {
+        CheckpointHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+        header.k = k;
+        header.complements = complements;
+        header.lowerBound = lowerBound;
+        header.count = count;
+        return header;
+    }
+
+    static bool ReadHeader(std::istream &in, CheckpointHeader &header) {
+        return in.read((char*)&header, sizeof(header)) && !memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    }
+
+    /// Return whether the header was written for the given count of k-mers, k, complements and lowerBound.
+    static bool Matches(const CheckpointHeader &header, size_t count, int k, bool complements, bool lowerBound) {
+        return (int)header.k == k && (bool)header.complements == complements && (bool)header.lowerBound == lowerBound
+            && header.count == count;
+    }
+
+    /// Call f(index, first, second) for each complete record until the end of the log.
+    template <typename f_t>
+    static void ForEachRecord(std::istream &in, f_t f) {
+        std::vector<record_t> buffer(CHECKPOINT_BUFFER_SIZE);
+        size_t index = 0;
+        while (in.read((char*)buffer.data(), buffer.size() * sizeof(record_t)) || in.gcount()) {
+            size_t count = in.gcount() / sizeof(record_t);
+            for (size_t r = 0; r < count; ++r, ++index) f(index, buffer[r].first, buffer[r].second);
+            if (!in) break;
+        }
+    }
+
+    void Fail() {
+        if (!failed.exchange(true)) std::cerr << "Warning: cannot write the checkpoint to '" << dir << "'." << std::endl;
+    }
+
+    std::string dir;
+    bool resume;
+    int memoryReductionFactor = 1;
+    std::ofstream log;
+    std::vector<record_t> edges, pending;
+    std::thread kMersWriter, edgesWriter;
+    std::atomic<bool> failed = false;
+};
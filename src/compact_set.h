@@ -0,0 +1,256 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "kmers.h"
+#include "khash_utils.h"
+
+/// The maximum number of slots in one bucket of the compact set.
+constexpr size_t COMPACT_MAX_BUCKET_SIZE = 16;
+/// The expected number of k-mers in a bucket is at least this and less than twice this.
+constexpr size_t COMPACT_MIN_BUCKET_LOAD = 6;
+/// The expected fraction of occupied slots; higher values lead to more k-mers in the overflow table.
+constexpr double COMPACT_LOAD_FACTOR = 0.7;
+
+/// Exact set of k-mers which stores only the remainders of the k-mers.
+/// Each k-mer is first permuted by an invertible hash. The top q bits of the hash select one of 2^q buckets
+/// and only the remaining 2k-q bits are stored in one of the bucket slots, so the k-mer can be reconstructed.
+/// The k-mers which do not fit into their bucket are stored whole in an overflow hash table.
+/// The set supports the operations used by Local, i.e. membership, removal and iteration.
+template <typename kmer_t, typename kh_wrapper_t>
+class CompactKMerSet {
+public:
+    /// Create an empty set for about the given number of k-mers.
+    CompactKMerSet(kh_wrapper_t wrapper, size_t expectedSize, int k) : wrapper(wrapper) {
+        bits = 2 * k;
+        lowBits = std::min(bits, 64);
+        quotientBits = 0;
+        while (quotientBits < lowBits && (expectedSize >> (quotientBits + 1)) >= COMPACT_MIN_BUCKET_LOAD) ++quotientBits;
+        remainderBits = bits - quotientBits;
+        double load = double(expectedSize) / double(size_t(1) << quotientBits);
+        bucketSize = std::min(COMPACT_MAX_BUCKET_SIZE, size_t(load / COMPACT_LOAD_FACTOR) + 1);
+        occupied.assign(size_t(1) << quotientBits, 0);
+        // One extra word so that reading a remainder never needs a bounds check.
+        remainders.assign((SlotsCount() * remainderBits + 63) / 64 + 1, 0);
+        lowMask = lowBits == 64 ? ~uint64_t(0) : (uint64_t(1) << lowBits) - 1;
+        lowRemainderBits = lowBits - quotientBits;
+        inverse1 = ModularInverse(MULTIPLIER_1);
+        inverse2 = ModularInverse(MULTIPLIER_2);
+        overflow = wrapper.kh_init_set();
+    }
+
+    CompactKMerSet(const CompactKMerSet&) = delete;
+    CompactKMerSet &operator=(const CompactKMerSet&) = delete;
+
+    ~CompactKMerSet() {
+        wrapper.kh_destroy_set(overflow);
+    }
+
+    /// Insert the k-mer. Return false if it was already present.
+    bool Insert(kmer_t kMer) {
+        size_t bucket;
+        kmer_t remainder;
+        Split(kMer, bucket, remainder);
+        if (FindInBucket(bucket, remainder) != bucketSize) return false;
+        if (wrapper.kh_get_from_set(overflow, kMer) != kh_end(overflow)) return false;
+        ++size;
+        for (size_t slot = 0; slot < bucketSize; ++slot) {
+            if (occupied[bucket] & (1 << slot)) continue;
+            occupied[bucket] |= 1 << slot;
+            WriteRemainder(bucket * bucketSize + slot, remainder);
+            return true;
+        }
+        int ret;
+        wrapper.kh_put_to_set(overflow, kMer, &ret);
+        return true;
+    }
+
+    /// Determine whether the k-mer is present.
+    bool Contains(kmer_t kMer) {
+        size_t bucket;
+        kmer_t remainder;
+        Split(kMer, bucket, remainder);
+        if (FindInBucket(bucket, remainder) != bucketSize) return true;
+        return kh_size(overflow) && wrapper.kh_get_from_set(overflow, kMer) != kh_end(overflow);
+    }
+
+    /// Remove the k-mer if present.
+    void Erase(kmer_t kMer) {
+        size_t bucket;
+        kmer_t remainder;
+        Split(kMer, bucket, remainder);
+        size_t slot = FindInBucket(bucket, remainder);
+        if (slot != bucketSize) {
+            occupied[bucket] &= ~(1 << slot);
+            --size;
+            return;
+        }
+        if (!kh_size(overflow)) return;
+        auto key = wrapper.kh_get_from_set(overflow, kMer);
+        if (key != kh_end(overflow)) {
+            wrapper.kh_del_from_set(overflow, key);
+            --size;
+        }
+    }
+
+    /// Find the first k-mer at the index or after it and update the index.
+    /// The slots are indexed first, followed by the overflow table. Return false if there are no more k-mers.
+    bool Next(size_t &index, kmer_t &kMer) {
+        for (; index < SlotsCount(); ++index) {
+            size_t bucket = index / bucketSize;
+            if (!(occupied[bucket] & (1 << (index % bucketSize)))) continue;
+            kMer = Join(bucket, ReadRemainder(index));
+            return true;
+        }
+        for (size_t i = kh_begin(overflow) + index - SlotsCount(); i != kh_end(overflow); ++i, ++index) {
+            if (!kh_exist(overflow, i)) continue;
+            kMer = kh_key(overflow, i);
+            return true;
+        }
+        return false;
+    }
+
+    /// Return the number of k-mers in the set.
+    size_t Size() const {
+        return size;
+    }
+
+    /// Return the number of k-mers stored in the overflow table.
+    size_t OverflowSize() const {
+        return kh_size(overflow);
+    }
+
+    /// Return the number of slots for the remainders.
+    size_t SlotsCount() const {
+        return occupied.size() * bucketSize;
+    }
+
+    /// Return the number of bits of one stored remainder.
+    int RemainderBits() const {
+        return remainderBits;
+    }
+
+private:
+    static constexpr uint64_t MULTIPLIER_1 = 0x9E3779B97F4A7C15ULL;
+    static constexpr uint64_t MULTIPLIER_2 = 0xC2B2AE3D27D4EB4FULL;
+
+    /// Return the inverse of the odd number modulo 2^64 using the Newton's method.
+    static uint64_t ModularInverse(uint64_t a) {
+        uint64_t inverse = a;
+        // Each iteration doubles the number of correct low bits.
+        for (int i = 0; i < 5; ++i) inverse *= 2 - a * inverse;
+        return inverse;
+    }
+
+    /// Shift the value left, returning 0 if the shift is at least 64.
+    static uint64_t ShiftLeft(uint64_t value, int shift) {
+        return shift >= 64 ? 0 : value << shift;
+    }
+
+    /// Permute the lowBits-bit values invertibly by multiplications and a xor-shift modulo 2^lowBits.
+    uint64_t Permute(uint64_t value) const {
+        value = (value * MULTIPLIER_1) & lowMask;
+        value ^= value >> ((lowBits + 1) / 2);
+        return (value * MULTIPLIER_2) & lowMask;
+    }
+
+    /// Invert Permute; the xor-shift is an involution as it shifts by at least half of the bits.
+    uint64_t InversePermute(uint64_t value) const {
+        value = (value * inverse2) & lowMask;
+        value ^= value >> ((lowBits + 1) / 2);
+        return (value * inverse1) & lowMask;
+    }
+
+    /// Split the k-mer into the bucket and the remainder.
+    /// The bits above the lowest 64 are kept in the remainder and only used to scramble the low bits.
+    void Split(kmer_t kMer, size_t &bucket, kmer_t &remainder) const {
+        kmer_t high = bits > 64 ? kMer >> lowBits : kmer_t(0);
+        uint64_t low = (uint64_t)(kMer & kmer_t(lowMask));
+        low = Permute(low ^ (MixHash(FoldKMer(high)) & lowMask));
+        bucket = lowRemainderBits >= 64 ? 0 : low >> lowRemainderBits;
+        remainder = kmer_t(low & ~ShiftLeft(~uint64_t(0), lowRemainderBits));
+        if (bits > 64) remainder |= high << lowRemainderBits;
+    }
+
+    /// Reconstruct the k-mer from its bucket and remainder.
+    kmer_t Join(size_t bucket, kmer_t remainder) const {
+        // The k-mer may fill the whole integer, in which case it has no high bits and the shift would overflow.
+        kmer_t high = bits > 64 ? remainder >> lowRemainderBits : kmer_t(0);
+        uint64_t low = ShiftLeft(bucket, lowRemainderBits) |
+                       ((uint64_t)(remainder & kmer_t(lowMask)) & ~ShiftLeft(~uint64_t(0), lowRemainderBits));
+        low = InversePermute(low) ^ (MixHash(FoldKMer(high)) & lowMask);
+        return bits > 64 ? (high << lowBits) | kmer_t(low) : kmer_t(low);
+    }
+
+    /// Return the slot of the bucket containing the remainder or bucketSize if there is none.
+    size_t FindInBucket(size_t bucket, kmer_t remainder) const {
+        for (size_t slot = 0; slot < bucketSize; ++slot) {
+            if ((occupied[bucket] & (1 << slot)) && ReadRemainder(bucket * bucketSize + slot) == remainder) return slot;
+        }
+        return bucketSize;
+    }
+
+    /// Read at most 64 bits starting at the given bit.
+    uint64_t ReadBits(size_t position, int width) const {
+        size_t word = position / 64, offset = position % 64;
+        uint64_t value = remainders[word] >> offset;
+        if (offset + width > 64) value |= remainders[word + 1] << (64 - offset);
+        return width == 64 ? value : value & ((uint64_t(1) << width) - 1);
+    }
+
+    /// Write at most 64 bits starting at the given bit.
+    void WriteBits(size_t position, int width, uint64_t value) {
+        size_t word = position / 64, offset = position % 64;
+        uint64_t mask = width == 64 ? ~uint64_t(0) : (uint64_t(1) << width) - 1;
+        remainders[word] = (remainders[word] & ~(mask << offset)) | (value << offset);
+        if (offset + width > 64) {
+            remainders[word + 1] = (remainders[word + 1] & ~(mask >> (64 - offset))) | (value >> (64 - offset));
+        }
+    }
+
+    kmer_t ReadRemainder(size_t slot) const {
+        kmer_t remainder = 0;
+        for (int done = 0; done < remainderBits; done += 64) {
+            remainder |= kmer_t(ReadBits(slot * remainderBits + done, std::min(64, remainderBits - done))) << done;
+        }
+        return remainder;
+    }
+
+    void WriteRemainder(size_t slot, kmer_t remainder) {
+        for (int done = 0; done < remainderBits; done += 64) {
+            WriteBits(slot * remainderBits + done, std::min(64, remainderBits - done), (uint64_t)(remainder >> done));
+        }
+    }
+
+    kh_wrapper_t wrapper;
+    int bits, lowBits, quotientBits, remainderBits, lowRemainderBits;
+    size_t bucketSize;
+    uint64_t lowMask, inverse1, inverse2;
+    std::vector<uint16_t> occupied;
+    std::vector<uint64_t> remainders;
+    decltype(wrapper.kh_init_set()) overflow;
+    size_t size = 0;
+};
+
+/// Determine whether the k-mer or its reverse complement is present.
+template <typename kmer_t, typename kh_wrapper_t>
+bool containsKMer(CompactKMerSet<kmer_t, kh_wrapper_t> *kMers, [[maybe_unused]] kh_wrapper_t wrapper, kmer_t kMer,
+                  int k, bool complements) {
+    return kMers->Contains(kMer) || (complements && kMers->Contains(ReverseComplement(kMer, k)));
+}
+
+/// Remove the k-mer and its reverse complement.
+template <typename kmer_t, typename kh_wrapper_t>
+void eraseKMer(CompactKMerSet<kmer_t, kh_wrapper_t> *kMers, [[maybe_unused]] kh_wrapper_t wrapper, kmer_t kMer,
+               int k, bool complements) {
+    kMers->Erase(kMer);
+    if (complements) kMers->Erase(ReverseComplement(kMer, k));
+}
+
+/// Find the next k-mer in the k-mer set and update the index. Return false if there are no more k-mers.
+template <typename kmer_t, typename kh_wrapper_t>
+bool nextKMer(CompactKMerSet<kmer_t, kh_wrapper_t> *kMers, kmer_t &kMer, size_t &lastIndex) {
+    return kMers->Next(lastIndex, kMer);
+}
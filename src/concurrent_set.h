@@ -0,0 +1,155 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "kmers.h"
+#include "khash_utils.h"
+
+/// The maximum expected fraction of occupied slots of the concurrent set; linear probing slows down above it.
+constexpr double CONCURRENT_MAX_LOAD = 0.7;
+
+/// Set of k-mers with a fixed capacity which supports concurrent insertions, lookups and removals without locks.
+/// The k-mers are stored by linear probing and each slot has a state which is only changed by compare-and-swap:
+/// EMPTY -> BUSY when a thread claims the slot for its k-mer, BUSY -> FULL after the k-mer is written,
+/// and FULL <-> DELETED on removal and re-insertion of the same k-mer.
+/// Memory ordering: the k-mer is written before FULL is stored with release semantics and the states are loaded
+/// with acquire semantics, so a thread which sees FULL or DELETED also sees the k-mer. A thread which sees BUSY
+/// waits for the k-mer as it may be the one it is looking for.
+/// A removed k-mer keeps its slot, which is never reused for another k-mer. Hence each k-mer occupies at most one slot
+/// during the whole lifetime of the set, which keeps the lookups correct without locks.
+template <typename kmer_t>
+class ConcurrentKMerSet {
+public:
+    /// Create an empty set with capacity for the given number of k-mers at the load of at most CONCURRENT_MAX_LOAD.
+    explicit ConcurrentKMerSet(size_t expectedSize) {
+        capacity = 16;
+        while (capacity * CONCURRENT_MAX_LOAD < expectedSize) capacity *= 2;
+        // The states are zeroed, i.e. EMPTY, while the keys are left uninitialized until their slot is claimed.
+        states = std::make_unique<std::atomic<uint8_t>[]>(capacity);
+        keys.reset(new kmer_t[capacity]);
+    }
+
+    /// Insert the k-mer. Return false if it was already present.
+    /// Throw std::length_error if there is no free slot for the k-mer.
+    bool Insert(kmer_t kMer) {
+        size_t index = Home(kMer);
+        for (size_t probes = 0; probes < capacity; ++probes, index = (index + 1) & (capacity - 1)) {
+            uint8_t state = states[index].load(std::memory_order_acquire);
+            if (state == EMPTY) {
+                if (states[index].compare_exchange_strong(state, BUSY, std::memory_order_acquire)) {
+                    keys[index] = kMer;
+                    states[index].store(FULL, std::memory_order_release);
+                    size.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+                // Another thread claimed the slot; examine it again.
+            }
+            state = WaitWhileBusy(index, state);
+            if (keys[index] != kMer) continue;
+            while (state == DELETED) {
+                if (states[index].compare_exchange_weak(state, FULL, std::memory_order_acq_rel)) {
+                    size.fetch_add(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+        throw std::length_error("Concurrent k-mer set is full.");
+    }
+
+    /// Determine whether the k-mer is present.
+    bool Contains(kmer_t kMer) const {
+        size_t index = Home(kMer);
+        for (size_t probes = 0; probes < capacity; ++probes, index = (index + 1) & (capacity - 1)) {
+            uint8_t state = WaitWhileBusy(index, states[index].load(std::memory_order_acquire));
+            if (state == EMPTY) return false;
+            if (keys[index] == kMer) return state == FULL;
+        }
+        return false;
+    }
+
+    /// Remove the k-mer. Return false if it was not present.
+    bool Erase(kmer_t kMer) {
+        size_t index = Home(kMer);
+        for (size_t probes = 0; probes < capacity; ++probes, index = (index + 1) & (capacity - 1)) {
+            uint8_t state = WaitWhileBusy(index, states[index].load(std::memory_order_acquire));
+            if (state == EMPTY) return false;
+            if (keys[index] != kMer) continue;
+            while (state == FULL) {
+                if (states[index].compare_exchange_weak(state, DELETED, std::memory_order_acq_rel)) {
+                    size.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+        return false;
+    }
+
+    /// Find the first k-mer at the index or after it and update the index. Return false if there are no more k-mers.
+    /// Not safe to call concurrently with modifications.
+    bool Next(size_t &index, kmer_t &kMer) const {
+        for (; index < capacity; ++index) {
+            if (states[index].load(std::memory_order_acquire) != FULL) continue;
+            kMer = keys[index];
+            return true;
+        }
+        return false;
+    }
+
+    /// Return the number of k-mers in the set.
+    size_t Size() const {
+        return size.load(std::memory_order_relaxed);
+    }
+
+    /// Return the number of slots.
+    size_t Capacity() const {
+        return capacity;
+    }
+
+private:
+    enum State : uint8_t { EMPTY, BUSY, FULL, DELETED };
+
+    size_t Home(kmer_t kMer) const {
+        return MixHash(FoldKMer(kMer)) & (capacity - 1);
+    }
+
+    /// Wait until the k-mer in the slot is written and return the new state of the slot.
+    uint8_t WaitWhileBusy(size_t index, uint8_t state) const {
+        while (state == BUSY) {
+            std::this_thread::yield();
+            state = states[index].load(std::memory_order_acquire);
+        }
+        return state;
+    }
+
+    size_t capacity;
+    std::unique_ptr<std::atomic<uint8_t>[]> states;
+    std::unique_ptr<kmer_t[]> keys;
+    std::atomic<size_t> size{0};
+};
+
+/// Determine whether the k-mer or its reverse complement is present.
+template <typename kmer_t, typename kh_wrapper_t>
+bool containsKMer(ConcurrentKMerSet<kmer_t> *kMers, [[maybe_unused]] kh_wrapper_t wrapper, kmer_t kMer,
+                  int k, bool complements) {
+    return kMers->Contains(kMer) || (complements && kMers->Contains(ReverseComplement(kMer, k)));
+}
+
+/// Remove the k-mer and its reverse complement.
+template <typename kmer_t, typename kh_wrapper_t>
+void eraseKMer(ConcurrentKMerSet<kmer_t> *kMers, [[maybe_unused]] kh_wrapper_t wrapper, kmer_t kMer,
+               int k, bool complements) {
+    kMers->Erase(kMer);
+    if (complements) kMers->Erase(ReverseComplement(kMer, k));
+}
+
+/// Find the next k-mer in the k-mer set and update the index. Return false if there are no more k-mers.
+template <typename kmer_t>
+bool nextKMer(ConcurrentKMerSet<kmer_t> *kMers, kmer_t &kMer, size_t &lastIndex) {
+    return kMers->Next(lastIndex, kMer);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "kmers.h"
+
+/// The number of characters encoded by one call of EncodeNucleotides.
+constexpr size_t ENCODING_BLOCK_SIZE = 64;
+
+/// Encode the characters to 2-bit nucleotide codes using the lookup table.
+/// Return the bitmask of characters which are not nucleotides and store the bitmask of lowercase ones.
+/// Codes of the invalid characters are unspecified.
+inline uint64_t EncodeNucleotidesScalar(const char *sequence, size_t length, uint8_t *codes, uint64_t &lowercase) {
+    uint64_t invalid = 0;
+    lowercase = 0;
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t data = nucleotideToInt[(uint8_t)sequence[i]];
+        codes[i] = data & 3;
+        invalid |= uint64_t(data >> 2) << i;
+        lowercase |= uint64_t(sequence[i] > 'Z') << i;
+    }
+    return invalid;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+/// Encode the full block of ENCODING_BLOCK_SIZE characters using SIMD instructions.
+/// The code of a nucleotide is ((c >> 1) ^ (c >> 2)) & 3 for both upper and lower case.
+inline uint64_t EncodeNucleotidesBlock(const char *sequence, uint8_t *codes, uint64_t &lowercase) {
+    uint64_t invalid = 0;
+    lowercase = 0;
+#if defined(__AVX2__)
+    const __m256i caseBit = _mm256_set1_epi8(0x20), three = _mm256_set1_epi8(3);
+    for (size_t i = 0; i < ENCODING_BLOCK_SIZE; i += 32) {
+        __m256i chars = _mm256_loadu_si256((const __m256i*)(sequence + i));
+        __m256i lower = _mm256_or_si256(chars, caseBit);
+        __m256i valid = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('a')), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('c'))),
+                _mm256_or_si256(_mm256_cmpeq_epi8(lower, _mm256_set1_epi8('g')), _mm256_cmpeq_epi8(lower, _mm256_set1_epi8('t'))));
+        // Shifting 16-bit lanes moves bits between bytes, but only above the two lowest bits.
+        __m256i code = _mm256_and_si256(_mm256_xor_si256(_mm256_srli_epi16(chars, 1), _mm256_srli_epi16(chars, 2)), three);
+        _mm256_storeu_si256((__m256i*)(codes + i), code);
+        invalid |= uint64_t(~uint32_t(_mm256_movemask_epi8(valid))) << i;
+        lowercase |= uint64_t(uint32_t(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(chars, caseBit), caseBit)))) << i;
+    }
+#else
+    const __m128i caseBit = _mm_set1_epi8(0x20), three = _mm_set1_epi8(3);
+    for (size_t i = 0; i < ENCODING_BLOCK_SIZE; i += 16) {
+        __m128i chars = _mm_loadu_si128((const __m128i*)(sequence + i));
+        __m128i lower = _mm_or_si128(chars, caseBit);
+        __m128i valid = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('a')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('c'))),
+                _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('g')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('t'))));
+        // Shifting 16-bit lanes moves bits between bytes, but only above the two lowest bits.
+        __m128i code = _mm_and_si128(_mm_xor_si128(_mm_srli_epi16(chars, 1), _mm_srli_epi16(chars, 2)), three);
+        _mm_storeu_si128((__m128i*)(codes + i), code);
+        invalid |= uint64_t(~uint32_t(_mm_movemask_epi8(valid)) & 0xFFFF) << i;
+        lowercase |= uint64_t(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(chars, caseBit), caseBit))) << i;
+    }
+#endif
+    return invalid;
+}
+#endif
+
+/// Encode up to ENCODING_BLOCK_SIZE characters to 2-bit nucleotide codes.
+/// Return the bitmask of characters which are not nucleotides and store the bitmask of lowercase ones.
+/// Codes of the invalid characters are unspecified.
+inline uint64_t EncodeNucleotides(const char *sequence, size_t length, uint8_t *codes, uint64_t &lowercase) {
+#if defined(__AVX2__) || defined(__SSE2__)
+    if (length == ENCODING_BLOCK_SIZE) return EncodeNucleotidesBlock(sequence, codes, lowercase);
+#endif
+    return EncodeNucleotidesScalar(sequence, length, codes, lowercase);
+}
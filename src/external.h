@@ -0,0 +1,130 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#include "parser.h"
+#include "parallel.h"
+#include "khash_utils.h"
+#include "kmers.h"
+
+/// The maximal length of minimizers used for partitioning the k-mers.
+constexpr int MINIMIZER_LENGTH = 15;
+/// The number of bucket files to which the k-mers are partitioned.
+constexpr size_t EXTERNAL_BUCKETS_COUNT = 256;
+/// The size of the write buffer of each bucket file.
+constexpr size_t EXTERNAL_BUFFER_SIZE = 1 << 16;
+
+/// Split the sequence consisting only of nucleotides into super-k-mers, i.e. maximal runs of consecutive k-mers
+/// whose minimizers belong to the same bucket, and call the callback with the bucket, start and length of each.
+/// If complements is true, canonical m-mers are used so that a k-mer and its reverse complement share the bucket.
+template <typename F>
+void ForEachSuperKMer(const char *sequence, size_t length, int k, bool complements, size_t bucketsCount, F &&callback) {
+    int m = std::min(k, MINIMIZER_LENGTH);
+    if (length < (size_t)k) return;
+    uint64_t mask = (uint64_t(1) << (2 * m)) - 1;
+    int shift = 2 * (m - 1);
+    uint64_t mMer = 0, reverseComplement = 0;
+    // Monotone queue of (hash, position) of the m-mers in the current window.
+    std::deque<std::pair<uint64_t, size_t>> window;
+    size_t superKMerStart = 0, currentBucket = 0;
+    for (size_t i = 0; i < length; ++i) {
+        uint8_t data = nucleotideToInt[(uint8_t)sequence[i]];
+        mMer = ((mMer << 2) | data) & mask;
+        reverseComplement = (reverseComplement >> 2) | (uint64_t(3 ^ data) << shift);
+        if (i + 1 < (size_t)m) continue;
+        size_t position = i + 1 - m;
+        // Hash the m-mers so that minimizers are not biased towards poly-A.
+        uint64_t hash = MixHash(complements ? std::min(mMer, reverseComplement) : mMer);
+        while (!window.empty() && window.back().first > hash) window.pop_back();
+        window.emplace_back(hash, position);
+        if (i + 1 < (size_t)k) continue;
+        size_t kMerStart = i + 1 - k;
+        while (window.front().second < kMerStart) window.pop_front();
+        size_t bucket = window.front().first % bucketsCount;
+        if (kMerStart == 0) {
+            currentBucket = bucket;
+        } else if (bucket != currentBucket) {
+            callback(currentBucket, superKMerStart, kMerStart - 1 + k - superKMerStart);
+            currentBucket = bucket;
+            superKMerStart = kMerStart;
+        }
+    }
+    callback(currentBucket, superKMerStart, length - superKMerStart);
+}
+
+/// Partition the k-mers from the fasta files into bucket files in the given directory.
+/// Each bucket file contains super-k-mers separated by newlines.
+/// Return the paths of the bucket files.
+std::vector<std::string> PartitionKMers(std::vector<std::string> &paths, int k, bool complements, const std::string &directory,
+                                        size_t bucketsCount) {
+    std::vector<std::string> bucketPaths(bucketsCount);
+    std::vector<FILE*> buckets(bucketsCount);
+    for (size_t i = 0; i < bucketsCount; ++i) {
+        bucketPaths[i] = directory + "/kmercamel-" + std::to_string(getpid()) + "-" + std::to_string(i) + ".txt";
+        buckets[i] = fopen(bucketPaths[i].c_str(), "w");
+        if (buckets[i] == nullptr) {
+            throw std::invalid_argument("couldn't create temporary file " + bucketPaths[i]);
+        }
+        setvbuf(buckets[i], nullptr, _IOFBF, EXTERNAL_BUFFER_SIZE);
+    }
+    for (auto &&path : paths) {
+        InputFile *fp = OpenFile(path);
+        kseq_t *seq = kseq_init(fp);
+        while (kseq_read(seq) >= 0) {
+            // Split the sequence at non-nucleotide characters.
+            size_t segmentStart = 0;
+            for (size_t i = 0; i <= seq->seq.l; ++i) {
+                if (i < seq->seq.l && nucleotideToInt[(uint8_t)seq->seq.s[i]] < 4) continue;
+                ForEachSuperKMer(seq->seq.s + segmentStart, i - segmentStart, k, complements, bucketsCount,
+                                 [&](size_t bucket, size_t start, size_t length) {
+                    fwrite(seq->seq.s + segmentStart + start, 1, length, buckets[bucket]);
+                    fputc('\n', buckets[bucket]);
+                });
+                segmentStart = i + 1;
+            }
+        }
+        kseq_destroy(seq);
+        CloseFile(fp);
+    }
+    for (auto bucket : buckets) {
+        if (fclose(bucket) != 0) throw std::runtime_error("couldn't write temporary files to " + directory);
+    }
+    return bucketPaths;
+}
+
+/// Load the k-mers using the disk instead of the memory.
+/// The k-mers are first partitioned into bucket files by their minimizers,
+/// then each bucket is deduplicated separately and the resulting set is passed to consume.
+/// Since all the occurrences of a k-mer end up in the same bucket, the sets are disjoint.
+/// The buckets are processed by the given number of threads, but consume is called by one thread at a time.
+template <typename kmer_t, typename kh_wrapper_t, typename F>
+void ReadKMersExternal(kh_wrapper_t wrapper, kmer_t _, std::vector<std::string> &paths, int k, bool complements,
+                       const std::string &directory, int threads, F &&consume) {
+    auto bucketPaths = PartitionKMers(paths, k, complements, directory, EXTERNAL_BUCKETS_COUNT);
+    std::atomic<size_t> nextBucket(0);
+    std::mutex consumeLock;
+    RunInParallel(threads, [&](int) {
+        for (size_t bucket = nextBucket++; bucket < bucketPaths.size(); bucket = nextBucket++) {
+            auto *kMers = wrapper.kh_init_set();
+            std::ifstream bucketFile(bucketPaths[bucket]);
+            std::string superKMer;
+            while (std::getline(bucketFile, superKMer)) {
+                AddKMers(kMers, wrapper, _, superKMer.size(), superKMer.data(), k, complements);
+            }
+            bucketFile.close();
+            std::remove(bucketPaths[bucket].c_str());
+            {
+                std::lock_guard<std::mutex> lock(consumeLock);
+                consume(kMers);
+            }
+            wrapper.kh_destroy_set(kMers);
+        }
+    });
+}
@@ -5,11 +5,15 @@
 #include <unordered_map>
 #include <list>
 #include <algorithm>
+#include <tuple>
 #include <cstdint>
 
 #include "kmers.h"
 #include "khash.h"
 #include "khash_utils.h"
+#include "packed_array.h"
+#include "parallel.h"
+#include "checkpoint.h"
 
 /// Provide possibility to access reverse complements as if they were in the field.
 #define access(field, index) (((field).size() > (index)) ? (field)[(index)] : \
@@ -22,10 +26,16 @@
 
 /// Determines which fraction of k-mers store its prefixes at one time.
 int MEMORY_REDUCTION_FACTOR = 16;
+/// The largest number of parts into which global splits the prefixes to fit into the memory limit,
+/// as each part needs another pass over the suffixes.
+constexpr size_t MAX_MEMORY_PARTS = 64;
+/// The number of k-mers whose suffixes each thread of global looks up before the found edges are added.
+constexpr size_t GLOBAL_BLOCK_SIZE_PER_THREAD = 1 << 20;
 /// Determines the number of prefix bits based on which the k-mers are presorted.
 constexpr int SORT_FIRST_BITS_DEFAULT = 8;
 
-typedef std::pair<std::vector<size_t>, std::vector<unsigned char>> overlapPath;
+/// The successor of each k-mer, or size_t(-1) if there is none, and the overlaps with the successors.
+typedef std::pair<PackedIndexArray, std::vector<unsigned char>> overlapPath;
 
 /// Rearrange the k-mers so that k-mers next to each other in sorted order appear close so that they are in the same bucket.
 template <typename kmer_t>
@@ -41,7 +51,7 @@ void PartialPreSort(std::vector<kmer_t> &vals, int k) {
     for (uint64_t i = 0; i < DIFFERENT_PREFIXES_COUNT; ++i) distributed[i] = std::vector<kmer_t> (counts[i]);
     for (uint64_t i = 0; i < DIFFERENT_PREFIXES_COUNT; ++i) counts[i] = 0;
     for (auto &&kMer : vals) {
-        uint64_t index = (kMer & mask) >> shift;
+        uint64_t index = uint64_t((kMer & mask) >> shift);
         distributed[index][counts[index]++] = kMer;
     }
     size_t index = 0;
@@ -52,117 +62,494 @@ void PartialPreSort(std::vector<kmer_t> &vals, int k) {
     }
 }
 
+/// Rearrange the k-mers as PartialPreSort does, but write them directly to a packed array and free the vector.
+/// The k-mers are placed by a counting sort, so no buckets of all the k-mers are needed.
+template <typename kmer_t>
+PackedKMerArray<kmer_t> PartialPreSortPacked(std::vector<kmer_t> &vals, int k) {
+    int SORT_FIRST_BITS = std::min(2 * k, SORT_FIRST_BITS_DEFAULT);
+    uint64_t DIFFERENT_PREFIXES_COUNT = 1ULL << SORT_FIRST_BITS;
+    int shift = (2 * k) - SORT_FIRST_BITS;
+    std::vector<size_t> starts(DIFFERENT_PREFIXES_COUNT + 1, 0);
+    for (auto &&kMer : vals) starts[(uint64_t)(kMer >> shift) + 1]++;
+    for (uint64_t i = 0; i < DIFFERENT_PREFIXES_COUNT; ++i) starts[i + 1] += starts[i];
+    PackedKMerArray<kmer_t> packed(vals.size(), k);
+    for (auto &&kMer : vals) packed.Set(starts[(uint64_t)(kMer >> shift)]++, kMer);
+    std::vector<kmer_t>().swap(vals);
+    return packed;
+}
+
+/// Return the number of bytes taken by the k-mers.
+template <typename kmer_t>
+size_t KMersMemory(const std::vector<kmer_t> &kMers) {
+    return kMers.size() * sizeof(kmer_t);
+}
+
+/// Return the number of bytes taken by the packed k-mers.
+template <typename kmer_t>
+size_t KMersMemory(const PackedKMerArray<kmer_t> &kMers) {
+    return kMers.MemoryUsage();
+}
+
+/// Estimate the number of bytes of a map of prefixes sized for the given number of k-mers as in OverlapHamiltonianPath.
+/// Both khash and the Swiss table round the buckets up to a power of two and take at most a byte per bucket besides the slot.
+template <typename kmer_t>
+size_t PrefixMapMemory(size_t kMers) {
+    size_t buckets = 1;
+    while (buckets < (kMers + 1) * 100 / 77) buckets <<= 1;
+    return buckets * (sizeof(std::pair<kmer_t, size_t>) + 1);
+}
+
+/// Return the smallest number of parts, up to MAX_MEMORY_PARTS, such that the maps of prefixes of the allowed k-mers
+/// of one part and the arrays of the next k-mers of one part and, with more threads, of their order by shards fit into the available bytes.
+template <typename kmer_t>
+size_t PlanParts(size_t kMersCount, size_t allowed, size_t available, int threads) {
+    auto memory = [&](size_t parts) {
+        return (kMersCount / parts + 1) * PackedIndexArray::BytesPerIndex(kMersCount) * (threads > 1 ? 2 : 1)
+            + threads * PrefixMapMemory<kmer_t>(allowed / parts / threads);
+    };
+    size_t parts = 1;
+    while (parts < MAX_MEMORY_PARTS && memory(parts) > available) ++parts;
+    return parts;
+}
+
+/// Return the index of the map of prefixes which stores the given prefix if there is one map per thread.
+template <typename kmer_t>
+inline size_t PrefixShard(kmer_t prefix, int threads) {
+    return threads == 1 ? 0 : KMerShard(prefix, threads);
+}
+
+/// Insert the prefixes of length d of the allowed k-mers with indices from..to into the maps of their shards.
+/// With more threads, the k-mers are first partitioned by their shards into order by a parallel counting sort,
+/// which keeps the k-mers of each shard in the increasing order of their indices. Each map is then filled by one thread.
+/// The map stores the last k-mer with the prefix and next[i - from] is set to the previous k-mer with the same prefix.
+template <typename kmers_t, typename kh_wrapper_t, typename kh_P_t>
+void AddPrefixes(kh_wrapper_t wrapper, kmers_t &kMers, std::vector<kh_P_t*> &prefixes, const std::vector<bool> &prefixForbidden,
+                 PackedIndexArray &next, PackedIndexArray &order, size_t from, size_t to, int k, int d, int threads) {
+    typedef typename kmers_t::value_type kmer_t;
+    auto insert = [&](kh_P_t *map, size_t i, kmer_t prefix) {
+        next[i - from] = -1;
+        auto prefix_key = wrapper.kh_get_from_map(map, prefix);
+        if (prefix_key != kh_end(map)) {
+            next[i - from] = kh_val(map, prefix_key);
+        } else {
+            int ret;
+            prefix_key = wrapper.kh_put_to_map(map, prefix, &ret);
+        }
+        kh_value(map, prefix_key) = i;
+    };
+    if (threads == 1) {
+        auto forbidden = prefixForbidden.begin() + from;
+        for (size_t i = from; i < to; ++i, ++forbidden)
+            if (!*forbidden) insert(prefixes[0], i, BitPrefix(access(kMers, i), k, d));
+        return;
+    }
+    // Call f(i, shard) on the allowed k-mers in the range of the thread t in the order of their indices.
+    auto forEachAllowed = [&](int t, auto f) {
+        size_t begin = from + (to - from) * t / threads, end = from + (to - from) * (t + 1) / threads;
+        // Indexing the bit vector with an arbitrary begin is noticeably slower than advancing an iterator.
+        auto forbidden = prefixForbidden.begin() + begin;
+        for (size_t i = begin; i < end; ++i, ++forbidden)
+            if (!*forbidden) f(i, PrefixShard(BitPrefix(access(kMers, i), k, d), threads));
+    };
+    // positions[t][s] is first the number of the k-mers of the shard s in the range of the thread t
+    // and then the position in order of the next of them.
+    std::vector<std::vector<size_t>> positions(threads, std::vector<size_t>(threads, 0));
+    RunInParallel(threads, [&](int t) {
+        forEachAllowed(t, [&](size_t, size_t shard) { ++positions[t][shard]; });
+    });
+    // shardBegins[s] is the position in order of the first k-mer of the shard s.
+    std::vector<size_t> shardBegins(threads + 1, 0);
+    for (int shard = 0; shard < threads; ++shard) {
+        shardBegins[shard + 1] = shardBegins[shard];
+        for (int t = 0; t < threads; ++t) {
+            size_t count = positions[t][shard];
+            positions[t][shard] = shardBegins[shard + 1];
+            shardBegins[shard + 1] += count;
+        }
+    }
+    RunInParallel(threads, [&](int t) {
+        forEachAllowed(t, [&](size_t i, size_t shard) { order[positions[t][shard]++] = i; });
+    });
+    RunInParallel(threads, [&](int t) {
+        for (size_t position = shardBegins[t]; position < shardBegins[t + 1]; ++position) {
+            size_t i = order[position];
+            insert(prefixes[t], i, BitPrefix(access(kMers, i), k, d));
+        }
+    });
+}
+
+/// Look up the suffixes of length d of the allowed k-mers with indices from..to in the maps of prefixes.
+/// Each thread takes a contiguous range of the k-mers and sets found[t] to the pairs of the k-mer index
+/// and the last k-mer with the prefix equal to its suffix, so the pairs of all threads are in the order of the k-mers.
+template <typename kmers_t, typename kh_wrapper_t, typename kh_P_t>
+void FindSuffixes(kh_wrapper_t wrapper, kmers_t &kMers, std::vector<kh_P_t*> &prefixes, const std::vector<bool> &suffixForbidden,
+                  std::vector<std::vector<std::pair<size_t, size_t>>> &found, size_t from, size_t to, int k, int d, int threads) {
+    typedef typename kmers_t::value_type kmer_t;
+    RunInParallel(threads, [&](int t) {
+        found[t].clear();
+        size_t begin = from + (to - from) * t / threads, end = from + (to - from) * (t + 1) / threads;
+        // Indexing the bit vector with an arbitrary begin is noticeably slower than advancing an iterator.
+        auto forbidden = suffixForbidden.begin() + begin;
+        for (size_t i = begin; i < end; ++i, ++forbidden)
+            if (!*forbidden) {
+                kmer_t suffix = BitSuffix(access(kMers, i), d);
+                auto *map = prefixes[PrefixShard(suffix, threads)];
+                auto suffix_key = wrapper.kh_get_from_map(map, suffix);
+                if (suffix_key != kh_end(map)) found[t].emplace_back(i, kh_val(map, suffix_key));
+            }
+    });
+}
+
+/// Add the edge from the k-mer i to the k-mer j with overlap d and forbid the suffix of i and the prefix of j.
+/// With complements, add also the edge between the complementary k-mers in the opposite direction.
+/// first and last store the ends of the paths of the k-mers, as in OverlapHamiltonianPath.
+/// If allowedPrefixes is given, it is decreased by the number of newly forbidden prefixes.
+inline void AddOverlapEdges(PackedIndexArray &edgeFrom, std::vector<unsigned char> &overlaps,
+                            std::vector<bool> &suffixForbidden, std::vector<bool> &prefixForbidden,
+                            PackedIndexArray &first, PackedIndexArray &last, size_t i, size_t j, size_t n, bool complements, int d,
+                            size_t *allowedPrefixes = nullptr) {
+    size_t kMersCount = n * (1 + complements);
+    std::vector<std::pair<size_t, size_t>> new_edges({{i, j}});
+    if (complements) new_edges.emplace_back((j + n) % kMersCount, (i + n) % kMersCount);
+    for (auto [x, y]: new_edges) {
+        edgeFrom[x] = y;
+        overlaps[x] = d;
+        if (allowedPrefixes && !prefixForbidden[y]) --*allowedPrefixes;
+        prefixForbidden[y] = true;
+        auto lastY =  accessFirstLast(last, first, y, n);
+        auto firstX = accessFirstLast(first, last, x, n);
+        if (lastY < n) first[lastY] = firstX;
+        if (firstX < n) last[firstX] = lastY;
+        suffixForbidden[x] = true;
+    }
+}
+
 /// Greedily find the approximate Hamiltonian path with longest overlaps.
 /// k is the size of one k-mer and n is the number of distinct k-mers.
 /// If complements are provided, treat k-mer and its complement as identical.
 /// If this is the case, k-mers are expected to contain only one k-mer from a complement pair.
 /// Moreover, if so, the resulting Hamiltonian path contains two superstrings which are reverse complements of one another.
 /// If lower_bound is set to true, return a shortest cycle cover instead.
-template <typename kmer_t, typename kh_wrapper_t>
-overlapPath OverlapHamiltonianPath (kh_wrapper_t wrapper, std::vector<kmer_t> &kMers, int k, bool complements,
-                                    bool lower_bound = false) {
+/// The k-mers are either a std::vector or a PackedKMerArray.
+/// With more threads, the prefixes are stored in hash-partitioned maps built in parallel and the suffixes
+/// are looked up in parallel, while the edges are still added in the order of the k-mers.
+/// Therefore, the result does not depend on the number of threads.
+/// If maxMemory is set, the number of parts is not given by MEMORY_REDUCTION_FACTOR but chosen for each d
+/// as the smallest one for which the estimated memory of the allowed prefixes and the other arrays fits into maxMemory bytes.
+/// If checkpoint is given, the added edges are logged there and a resumed run continues after the last finished d.
+template <typename kmers_t, typename kh_wrapper_t>
+overlapPath OverlapHamiltonianPath (kh_wrapper_t wrapper, kmers_t &kMers, int k, bool complements,
+                                    bool lower_bound = false, int threads = 1, size_t maxMemory = 0,
+                                    GlobalCheckpoint *checkpoint = nullptr) {
+    typedef typename kmers_t::value_type kmer_t;
     size_t n = kMers.size();
     size_t kMersCount = n * (1 + complements);
-    size_t batchSize = kMersCount / MEMORY_REDUCTION_FACTOR + 1;
-    std::vector<size_t> edgeFrom(kMersCount, -1);
+    size_t parts = 0, batchSize = 0;
+    // The indices take 4 bytes unless there are at least 2^32 - 1 k-mers including the complements.
+    PackedIndexArray edgeFrom(kMersCount, kMersCount);
     std::vector<unsigned char> overlaps(kMersCount, -1);
     std::vector<bool> suffixForbidden(kMersCount, false);
     std::vector<bool> prefixForbidden(kMersCount, false);
     // For reverse complements, compute first from last and vice versa.
-    auto first = new size_t[n];
-    auto last = new size_t[n];
-    // Index next relative to the batch.
-    auto next = new size_t[batchSize];
+    PackedIndexArray first(n, kMersCount), last(n, kMersCount);
+    // Index next relative to the batch; order contains the allowed k-mers of the batch partitioned by the maps of their prefixes.
+    PackedIndexArray next, order;
     for (size_t i = 0; i < n; ++i) {
         first[i] = last[i] = i;
     }
-    auto *prefixes = wrapper.kh_init_map();
-    wrapper.kh_resize_map(prefixes, (kMersCount / MEMORY_REDUCTION_FACTOR + 1 ) * 100 / 77 );
-    for (int d = k - 1; d >= 0; --d) {
+    // Each thread fills the map of the prefixes in its shard.
+    std::vector<decltype(wrapper.kh_init_map())> prefixes(threads);
+    for (auto &&map : prefixes) map = wrapper.kh_init_map();
+    std::vector<std::vector<std::pair<size_t, size_t>>> found(threads);
+    size_t blockSize = size_t(threads) * GLOBAL_BLOCK_SIZE_PER_THREAD;
+    size_t fixedMemory = KMersMemory(kMers) + edgeFrom.MemoryUsage() + first.MemoryUsage() + last.MemoryUsage()
+            + overlaps.size() + 2 * kMersCount / 8 + blockSize * sizeof(std::pair<size_t, size_t>);
+    // The edges of a block are logged while those of the previous block are written.
+    if (checkpoint) fixedMemory += 2 * blockSize * sizeof(std::pair<uint64_t, uint64_t>);
+    if (maxMemory && fixedMemory >= maxMemory) {
+        std::cerr << "Warning: global needs at least " << (fixedMemory >> 20) << " MB, which exceeds the memory limit." << std::endl;
+    }
+    int lastFinished = k;
+    // The number of the k-mers whose prefixes are still allowed, which is kept by AddOverlapEdges.
+    size_t allowed = kMersCount;
+    if (checkpoint) lastFinished = checkpoint->OpenEdgeLog(n, k, complements, lower_bound, [&](size_t i, size_t j, int d) {
+        AddOverlapEdges(edgeFrom, overlaps, suffixForbidden, prefixForbidden, first, last, i, j, n, complements, d, &allowed);
+    });
+    for (int d = lastFinished - 1; d >= 0; --d) {
+        size_t plannedParts = MEMORY_REDUCTION_FACTOR;
+        if (maxMemory) {
+            // Plan again as the allowed prefixes shrink, so that fewer parts are needed.
+            plannedParts = PlanParts<kmer_t>(kMersCount, allowed, maxMemory > fixedMemory ? maxMemory - fixedMemory : 0, threads);
+        }
+        if (plannedParts != parts) {
+            parts = plannedParts;
+            batchSize = kMersCount / parts + 1;
+            // Free the previous arrays first, so that they do not add up to the peak memory.
+            next = PackedIndexArray();
+            order = PackedIndexArray();
+            next = PackedIndexArray(batchSize, kMersCount);
+            if (threads > 1) order = PackedIndexArray(batchSize, kMersCount);
+            for (auto &&map : prefixes) {
+                wrapper.kh_destroy_map(map);
+                map = wrapper.kh_init_map();
+                wrapper.kh_resize_map(map, (allowed / parts / threads + 1) * 100 / 77);
+            }
+        }
         // In order to reduce memory requirements, the prefixes are not processed at once, but in batches.
         // As a cost, this slows down the algorithm.
-        for (int part = 0; part < MEMORY_REDUCTION_FACTOR; part++) {
-            wrapper.kh_clear_map(prefixes);
+        for (size_t part = 0; part < parts; part++) {
+            for (auto &&map : prefixes) wrapper.kh_clear_map(map);
             for (size_t i = 0; i < batchSize; ++i) {
                 next[i] = (size_t)-1;
             }
             size_t to = std::min(kMersCount, (part + 1) * batchSize);
             size_t from = part * batchSize;
-            for (size_t i = from; i < to; ++i)
-                if (!prefixForbidden[i]) {
-                    next[i - from] = -1;
-                    kmer_t prefix = BitPrefix(access(kMers,i), k, d);
-                    auto prefix_key = wrapper.kh_get_from_map(prefixes, prefix);
-                    if (prefix_key != kh_end(prefixes)) {
-                        next[i - from] = kh_val(prefixes, prefix_key);
-                    } else {
-                        int ret;
-                        prefix_key = wrapper.kh_put_to_map(prefixes, prefix, &ret);
+            AddPrefixes(wrapper, kMers, prefixes, prefixForbidden, next, order, from, to, k, d, threads);
+            // The suffixes are looked up in parallel in blocks and the edges of each block are then added sequentially.
+            for (size_t blockFrom = 0; blockFrom < kMersCount; blockFrom += blockSize) {
+                FindSuffixes(wrapper, kMers, prefixes, suffixForbidden, found, blockFrom,
+                             std::min(kMersCount, blockFrom + blockSize), k, d, threads);
+                for (auto &&threadFound : found)
+                    for (auto [i, head] : threadFound) {
+                        // The k-mer may have been used by an edge added earlier in this block.
+                        if (suffixForbidden[i]) continue;
+                        size_t previous, j;
+                        previous = j = head;
+                        while (j != size_t(-1) && \
+                                // k-mers are complementary
+                               ((i + n) % (2 * n) == j \
+                               // forms a cycle
+                               || (!lower_bound && accessFirstLast(first, last, i, n) == j) \
+                               // k-mer is already used
+                               || prefixForbidden[j])) {
+                            size_t new_j = next[j - from];
+                            // If the k-mer is forbidden, remove it to keep the complexity linear.
+                            // This is not done with the first k-mer but that is not a problem.
+                            if (prefixForbidden[j]) next[previous - from] = new_j;
+                            else previous = j;
+                            j = new_j;
+                        }
+                        if (j == size_t(-1)) {
+                            continue;
+                        }
+                        AddOverlapEdges(edgeFrom, overlaps, suffixForbidden, prefixForbidden, first, last, i, j, n, complements, d, &allowed);
+                        if (checkpoint) checkpoint->AddEdge(i, j);
+                        next[previous - from] = next[j - from];
                     }
-                    kh_value(prefixes, prefix_key) = i;
+                if (checkpoint) checkpoint->WriteEdges();
+            }
+        }
+        if (checkpoint) checkpoint->FinishLevel(d);
+    }
+
+    if (checkpoint) checkpoint->Wait();
+    for (auto &&map : prefixes) wrapper.kh_destroy_map(map);
+    return {std::move(edgeFrom), std::move(overlaps)};
+}
+
+/// Reorder the first count indices of the k-mers sorted by their prefixes of length d + 1 and, with equal prefixes,
+/// by decreasing indices so that they are sorted by their prefixes of length d and, with equal prefixes, by decreasing indices.
+/// The k-mers with an equal prefix of length d form at most four runs, which are merged using the buffer.
+template <typename kmers_t>
+void MergePrefixRuns(const kmers_t &kMers, PackedIndexArray &byPrefix, PackedIndexArray &buffer, size_t count, int k, int d) {
+    typedef typename kmers_t::value_type kmer_t;
+    for (size_t begin = 0, end; begin < count; begin = end) {
+        kmer_t kMer = access(kMers, byPrefix[begin]);
+        kmer_t prefix = BitPrefix(kMer, k, d), runPrefix = BitPrefix(kMer, k, d + 1);
+        size_t runEnds[4];
+        int runs = 0;
+        for (end = begin + 1; end < count; ++end) {
+            kMer = access(kMers, byPrefix[end]);
+            if (BitPrefix(kMer, k, d) != prefix) break;
+            kmer_t extendedPrefix = BitPrefix(kMer, k, d + 1);
+            if (extendedPrefix != runPrefix) {
+                runEnds[runs++] = end;
+                runPrefix = extendedPrefix;
+            }
+        }
+        if (!runs) continue;
+        runEnds[runs++] = end;
+        for (size_t i = begin; i < end; ++i) buffer[i - begin] = byPrefix[i];
+        size_t heads[4];
+        for (int run = 0; run < runs; ++run) {
+            runEnds[run] -= begin;
+            heads[run] = run ? runEnds[run - 1] : 0;
+        }
+        for (size_t i = begin; i < end; ++i) {
+            int best = -1;
+            for (int run = 0; run < runs; ++run) {
+                if (heads[run] < runEnds[run] && (best == -1 || buffer[heads[run]] > buffer[heads[best]])) best = run;
+            }
+            byPrefix[i] = buffer[heads[best]++];
+        }
+    }
+}
+
+/// Reorder the first count indices of the k-mers sorted by their suffixes of length d + 1 so that they are sorted by their suffixes of length d.
+/// The k-mers form four runs by the first character of the suffix of length d + 1, which are merged into the buffer,
+/// and the buffer is then swapped with the indices.
+template <typename kmers_t>
+void MergeSuffixRuns(const kmers_t &kMers, PackedIndexArray &bySuffix, PackedIndexArray &buffer, size_t count, int k, int d) {
+    typedef typename kmers_t::value_type kmer_t;
+    size_t heads[4], ends[4];
+    kmer_t suffixes[4];
+    for (int c = 0; c < 4; ++c) {
+        size_t low = heads[c] = c ? ends[c - 1] : 0, high = count;
+        while (low < high) {
+            size_t middle = (low + high) / 2;
+            if (BitPrefix(BitSuffix(access(kMers, bySuffix[middle]), d + 1), d + 1, 1) == kmer_t(c)) low = middle + 1;
+            else high = middle;
+        }
+        ends[c] = low;
+    }
+    auto load = [&](int c) {
+        if (heads[c] < ends[c]) suffixes[c] = BitSuffix(access(kMers, bySuffix[heads[c]]), d);
+    };
+    for (int c = 0; c < 4; ++c) load(c);
+    for (size_t i = 0; i < count; ++i) {
+        int best = -1;
+        for (int c = 0; c < 4; ++c) {
+            if (heads[c] < ends[c] && (best == -1 || suffixes[c] < suffixes[best])) best = c;
+        }
+        buffer[i] = bySuffix[heads[best]++];
+        load(best);
+    }
+    std::swap(bySuffix, buffer);
+}
+
+/// Greedily find the same approximate Hamiltonian path as OverlapHamiltonianPath without hashing the prefixes.
+/// The indices of the allowed k-mers are kept in two arrays sorted by the prefixes and by the suffixes of length d of the k-mers,
+/// so the k-mers with the prefix equal to the suffix of each k-mer are found by a single merge-join of the arrays.
+/// The arrays are sorted only for d = k - 1 and then obtained for d - 1 by merging the runs of the arrays for d,
+/// so apart from the added edges and the k-mers of the indices, the memory is accessed sequentially.
+/// All the arrays store packed indices, so about 24 bytes per k-mer are needed on top of OverlapHamiltonianPath without the maps.
+/// The k-mers with equal prefixes are ordered by decreasing indices as in the maps of OverlapHamiltonianPath
+/// and the edges are added in the same order, so the result is identical.
+template <typename kmers_t>
+overlapPath OverlapHamiltonianPathMergeJoin(kmers_t &kMers, int k, bool complements, bool lower_bound = false) {
+    typedef typename kmers_t::value_type kmer_t;
+    size_t n = kMers.size();
+    size_t kMersCount = n * (1 + complements);
+    size_t batchSize = kMersCount / MEMORY_REDUCTION_FACTOR + 1;
+    PackedIndexArray edgeFrom(kMersCount, kMersCount);
+    std::vector<unsigned char> overlaps(kMersCount, -1);
+    std::vector<bool> suffixForbidden(kMersCount, false);
+    std::vector<bool> prefixForbidden(kMersCount, false);
+    PackedIndexArray first(n, kMersCount), last(n, kMersCount);
+    for (size_t i = 0; i < n; ++i) {
+        first[i] = last[i] = i;
+    }
+    // Only the first prefixCount and suffixCount indices are of the allowed k-mers.
+    PackedIndexArray byPrefix(kMersCount, kMersCount), bySuffix(kMersCount, kMersCount);
+    size_t prefixCount = kMersCount, suffixCount = kMersCount;
+    {
+        // The k-mers are sorted together with their indices, so that the sort does not look up the k-mers.
+        std::vector<std::pair<kmer_t, size_t>> sorted(kMersCount);
+        for (size_t i = 0; i < kMersCount; ++i) sorted[i] = {BitPrefix(access(kMers, i), k, k - 1), i};
+        std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) {
+            return a.first < b.first || (a.first == b.first && a.second > b.second);
+        });
+        for (size_t i = 0; i < kMersCount; ++i) byPrefix[i] = sorted[i].second;
+        for (size_t i = 0; i < kMersCount; ++i) sorted[i] = {BitSuffix(access(kMers, i), k - 1), i};
+        std::sort(sorted.begin(), sorted.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        for (size_t i = 0; i < kMersCount; ++i) bySuffix[i] = sorted[i].second;
+    }
+    // The buffer is used for merging the runs and then for the k-mers whose suffix is equal to some prefix.
+    PackedIndexArray buffer(kMersCount, kMersCount);
+    // match[i] is the first position in byPrefix of the k-mers with the prefix equal to the suffix of the k-mer i
+    // and groupEnd[position] is the end of the k-mers with the prefix equal to that at the first position.
+    PackedIndexArray match(kMersCount, kMersCount), groupEnd(kMersCount, kMersCount);
+    // next[position] is the next position in byPrefix which is not known to be used.
+    PackedIndexArray next(kMersCount, kMersCount);
+    for (int d = k - 1; d >= 0; --d) {
+        if (d < k - 1) {
+            // The used k-mers are never allowed again, so they are dropped before the runs are merged.
+            size_t count = 0;
+            for (size_t position = 0; position < prefixCount; ++position) {
+                if (!prefixForbidden[byPrefix[position]]) byPrefix[count++] = byPrefix[position];
+            }
+            prefixCount = count;
+            count = 0;
+            for (size_t position = 0; position < suffixCount; ++position) {
+                if (!suffixForbidden[bySuffix[position]]) bySuffix[count++] = bySuffix[position];
+            }
+            suffixCount = count;
+            MergeSuffixRuns(kMers, bySuffix, buffer, suffixCount, k, d);
+            MergePrefixRuns(kMers, byPrefix, buffer, prefixCount, k, d);
+        }
+        // Merge-join the arrays, so that match is set for the k-mers with the suffix equal to the prefix of some k-mers.
+        size_t suffixPosition = 0;
+        for (size_t begin = 0, end; begin < prefixCount; begin = end) {
+            kmer_t prefix = BitPrefix(access(kMers, byPrefix[begin]), k, d);
+            for (end = begin + 1; end < prefixCount && BitPrefix(access(kMers, byPrefix[end]), k, d) == prefix; ++end);
+            groupEnd[begin] = end;
+            for (; suffixPosition < suffixCount; ++suffixPosition) {
+                size_t i = bySuffix[suffixPosition];
+                kmer_t suffix = BitSuffix(access(kMers, i), d);
+                if (prefix < suffix) break;
+                if (suffix == prefix) match[i] = begin;
+            }
+        }
+        // Look up the k-mers in the order of OverlapHamiltonianPath.
+        size_t foundCount = 0;
+        for (size_t i = 0; i < kMersCount; ++i) {
+            if (match[i] != size_t(-1)) buffer[foundCount++] = i;
+        }
+        for (size_t position = 0; position < prefixCount; ++position) next[position] = position + 1;
+        for (int part = 0; part < MEMORY_REDUCTION_FACTOR; part++) {
+            size_t to = std::min(kMersCount, (part + 1) * batchSize);
+            size_t from = part * batchSize;
+            for (size_t f = 0; f < foundCount; ++f) {
+                size_t i = buffer[f];
+                if (suffixForbidden[i]) continue;
+                size_t begin = match[i], end = groupEnd[begin];
+                // The k-mers with equal prefixes are ordered by decreasing indices, so those of this part are contiguous.
+                if (byPrefix[begin] < from || byPrefix[end - 1] >= to) continue;
+                size_t position = begin, high = end;
+                while (position < high) {
+                    size_t middle = (position + high) / 2;
+                    if (byPrefix[middle] >= to) position = middle + 1;
+                    else high = middle;
                 }
-            for (size_t i = 0; i < kMersCount; ++i)
-                if (!suffixForbidden[i]) {
-                    kmer_t suffix = BitSuffix(access(kMers, i), d);
-                    auto suffix_key = wrapper.kh_get_from_map(prefixes, suffix);
-                    if (suffix_key == kh_end(prefixes)) continue;
-                    size_t previous, j;
-                    previous = j = kh_val(prefixes, suffix_key);
-                    while (j != size_t(-1) && \
-                            // k-mers are complementary
-                           ((i + n) % (2 * n) == j \
-                           // forms a cycle
-                           || (!lower_bound && accessFirstLast(first, last, i, n) == j) \
-                           // k-mer is already used
-                           || prefixForbidden[j])) {
-                        size_t new_j = next[j - from];
-                        // If the k-mer is forbidden, remove it to keep the complexity linear.
+                size_t previous = -1, j = -1;
+                for (; position < end && byPrefix[position] >= from; position = next[position]) {
+                    size_t candidate = byPrefix[position];
+                    if (prefixForbidden[candidate]) {
+                        // Skip the used k-mer next time to keep the complexity linear.
                         // This is not done with the first k-mer but that is not a problem.
-                        if (prefixForbidden[j]) next[previous - from] = new_j;
-                        else previous = j;
-                        j = new_j;
-                    }
-                    if (j == size_t(-1)) {
+                        if (previous != size_t(-1)) next[previous] = next[position];
                         continue;
                     }
-                    std::vector<std::pair<size_t, size_t>> new_edges({{i, j}});
-                    // Add also the edge between complementary k-mers in the opposite direction.
-                    if (complements) new_edges.emplace_back((j + n) % kMersCount, (i + n) % kMersCount);
-                    for (auto [x, y]: new_edges) {
-                        edgeFrom[x] = y;
-                        overlaps[x] = d;
-                        prefixForbidden[y] = true;
-                        auto lastY =  accessFirstLast(last, first, y, n);
-                        auto firstX = accessFirstLast(first, last, x, n);
-                        if (lastY < n) first[lastY] = firstX;
-                        if (firstX < n) last[firstX] = lastY;
-                        suffixForbidden[x] = true;
+                    // Skip the complementary k-mer and the k-mer which would form a cycle.
+                    if ((i + n) % (2 * n) != candidate && (lower_bound || accessFirstLast(first, last, i, n) != candidate)) {
+                        j = candidate;
+                        break;
                     }
-                    next[previous - from] = next[j - from];
+                    previous = position;
                 }
+                if (j == size_t(-1)) continue;
+                AddOverlapEdges(edgeFrom, overlaps, suffixForbidden, prefixForbidden, first, last, i, j, n, complements, d);
+            }
         }
+        for (size_t f = 0; f < foundCount; ++f) match[buffer[f]] = -1;
     }
-
-    wrapper.kh_destroy_map(prefixes);
-    delete[](next);
-    delete[](first);
-    delete[](last);
-    return {edgeFrom, overlaps};
+    return {std::move(edgeFrom), std::move(overlaps)};
 }
 
 /// Construct the superstring and its mask from the given overlapPath path in the overlap graph.
 /// If reverse complements are considered and the overlapPath path contains two paths which are reverse complements of one another,
 /// return only one of them.
-template <typename kmer_t>
-void SuperstringFromPath(const overlapPath &hamiltonianPath, const std::vector<kmer_t> &kMers, std::ostream& of, const int k, const bool complements) {
+template <typename kmers_t>
+void SuperstringFromPath(const overlapPath &hamiltonianPath, const kmers_t &kMers, std::ostream& of, const int k, const bool complements) {
+    typedef typename kmers_t::value_type kmer_t;
     size_t kMersCount = kMers.size() * (1 + complements);
-    auto edgeFrom = hamiltonianPath.first;
-    auto overlaps = hamiltonianPath.second;
+    auto &edgeFrom = hamiltonianPath.first;
+    auto &overlaps = hamiltonianPath.second;
 
     // Find the vertex in the overlap graph with in-degree 0.
     std::vector<bool> isStart(kMersCount, true);
-    for (auto edge : edgeFrom) {
-        if (edge != size_t(-1)) isStart[edge] = false;
+    for (size_t i = 0; i < edgeFrom.size(); ++i) {
+        if (edgeFrom[i] != size_t(-1)) isStart[edgeFrom[i]] = false;
     }
     size_t start = 0;
     for (; start < kMersCount && !isStart[start]; ++start);
@@ -194,13 +581,27 @@ void SuperstringFromPath(const overlapPath &hamiltonianPath, const std::vector<k
 /// This runs in O(n k), where n is the number of k-mers.
 /// If complements are provided, treat k-mer and its complement as identical.
 /// If this is the case, k-mers are expected not to contain both k-mer and its complement.
+/// If maxMemory is set, the batches of prefixes are planned to fit into maxMemory bytes.
+/// If checkpoint is given, the progress is saved there and a resumed run continues from it.
+/// Warning: this will destroy kMers.
+template <typename kmers_t, typename kh_wrapper_t>
+void Global(kh_wrapper_t wrapper, kmers_t &kMers, std::ostream& of, int k, bool complements, int threads = 1, size_t maxMemory = 0,
+            GlobalCheckpoint *checkpoint = nullptr) {
+    if (kMers.empty()) {
+        throw std::invalid_argument("input cannot be empty");
+    }
+    auto hamiltonianPath = OverlapHamiltonianPath(wrapper, kMers, k, complements, false, threads, maxMemory, checkpoint);
+    SuperstringFromPath(hamiltonianPath, kMers, of, k, complements);
+}
+
+/// Get the same superstring as Global by the global greedy algorithm with merge-joins instead of hashing.
 /// Warning: this will destroy kMers.
-template <typename kmer_t, typename kh_wrapper_t>
-void Global(kh_wrapper_t wrapper, std::vector<kmer_t> &kMers, std::ostream& of, int k, bool complements) {
+template <typename kmers_t>
+void GlobalMergeJoin(kmers_t &kMers, std::ostream& of, int k, bool complements) {
     if (kMers.empty()) {
         throw std::invalid_argument("input cannot be empty");
     }
-    auto hamiltonianPath = OverlapHamiltonianPath(wrapper, kMers, k, complements);
+    auto hamiltonianPath = OverlapHamiltonianPathMergeJoin(kMers, k, complements);
     SuperstringFromPath(hamiltonianPath, kMers, of, k, complements);
 }
 
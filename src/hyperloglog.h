@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+/// The number of hash bits selecting the register; the relative error of the estimate is about 1.04 / 2^(p/2).
+constexpr int HLL_PRECISION = 14;
+
+/// HyperLogLog sketch estimating the number of distinct elements in a constant memory of 2^HLL_PRECISION bytes.
+/// Each register keeps the maximum rank, i.e. the position of the first set bit, of the hashes mapped to it.
+class HyperLogLog {
+public:
+    HyperLogLog() : registers(size_t(1) << HLL_PRECISION, 0) {}
+
+    /// Add the element with the given uniformly distributed 64-bit hash.
+    void Add(uint64_t hash) {
+        size_t index = hash >> (64 - HLL_PRECISION);
+        // The sentinel bit ensures that the rank is at most 64 - HLL_PRECISION + 1.
+        uint64_t rest = (hash << HLL_PRECISION) | (uint64_t(1) << (HLL_PRECISION - 1));
+        uint8_t rank = __builtin_clzll(rest) + 1;
+        registers[index] = std::max(registers[index], rank);
+    }
+
+    /// Add the elements of the other sketch, so that this sketch estimates the size of the union.
+    void Merge(const HyperLogLog &other) {
+        for (size_t i = 0; i < registers.size(); ++i) registers[i] = std::max(registers[i], other.registers[i]);
+    }
+
+    /// Return the estimated number of distinct added elements.
+    /// Small cardinalities, for which the raw estimate is biased, are estimated by linear counting.
+    double Estimate() const {
+        double m = registers.size();
+        double sum = 0;
+        size_t zeros = 0;
+        for (auto rank : registers) {
+            sum += std::ldexp(1.0, -rank);
+            zeros += !rank;
+        }
+        double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+        if (estimate <= 2.5 * m && zeros) estimate = m * std::log(m / zeros);
+        return estimate;
+    }
+
+private:
+    std::vector<uint8_t> registers;
+};
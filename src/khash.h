@@ -208,6 +208,7 @@ static const double __ac_HASH_UPPER = 0.77;
 	extern void kh_destroy_##name(kh_##name##_t *h);					\
 	extern void kh_clear_##name(kh_##name##_t *h);						\
 	extern khint_t kh_get_##name(const kh_##name##_t *h, khkey_t key); 	\
+	extern void kh_prefetch_##name(const kh_##name##_t *h, khkey_t key); 	\
 	extern int kh_resize_##name(kh_##name##_t *h, khint_t new_n_buckets); \
 	extern khint_t kh_put_##name(kh_##name##_t *h, khkey_t key, int *ret); \
 	extern void kh_del_##name(kh_##name##_t *h, khint_t x);
@@ -245,6 +246,15 @@ static const double __ac_HASH_UPPER = 0.77;
 			return __ac_iseither(h->flags, i)? h->n_buckets : i;		\
 		} else return 0;												\
 	}																	\
+	SCOPE void kh_prefetch_##name(const kh_##name##_t *h, khkey_t key) 	\
+	{ /* Prefetch the flags, key and value of the first bucket probed by kh_get and kh_put for the key. */ \
+		if (h->n_buckets) {												\
+			khint_t i = __hash_func(key) & (h->n_buckets - 1);			\
+			__builtin_prefetch(h->flags + (i >> 4));					\
+			__builtin_prefetch(h->keys + i);							\
+			if (kh_is_map) __builtin_prefetch(h->vals + i);				\
+		}																\
+	}																	\
 	SCOPE int kh_resize_##name(kh_##name##_t *h, khint_t new_n_buckets) \
 	{ /* This function uses 0.25*n_buckets bytes of working space instead of [sizeof(key_t+val_t)+.25]*n_buckets. */ \
 		khint32_t *new_flags = 0;										\
@@ -487,6 +497,14 @@ static kh_inline khint_t __ac_Wang_hash(khint_t key)
  */
 #define kh_get(name, h, k) kh_get_##name(h, k)
 
+/*! @function
+  @abstract     Prefetch the bucket of a key so that a following kh_get or kh_put does not wait for memory.
+  @param  name  Name of the hash table [symbol]
+  @param  h     Pointer to the hash table [khash_t(name)*]
+  @param  k     Key [type of keys]
+ */
+#define kh_prefetch(name, h, k) kh_prefetch_##name(h, k)
+
 /*! @function
   @abstract     Remove a key from the hash table.
   @param  name  Name of the hash table [symbol]
@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <list>
+#include <algorithm>
+#include <type_traits>
 
 #include "kmers.h"
 #include "khash.h"
@@ -9,9 +11,13 @@
 
 #define kh_int128_hash_func(key) kh_int64_hash_func((khint64_t)((key)>>65^(key)^(key)<<21))
 #define kh_int128_hash_equal(a, b) ((a) == (b))
-#define kh_int256_hash_func(key) kh_int128_hash_func((__uint128_t)((key)>>129^(key)^(key)<<35))
 #define kh_int256_hash_equal(a, b) ((a) == (b))
 
+/// Hash the 256-bit k-mer for khash as the lowest 128 bits of key>>129 ^ key ^ key<<35, computed lane-wise.
+inline khint_t kh_int256_hash_func(const kmer256_t &key) {
+    return kh_int128_hash_func((key.hi >> 1) ^ key.lo ^ (key.lo << 35));
+}
+
 #define KHASH_MAP_INIT_INT128(name, khval_t)								\
 	KHASH_INIT(name, __uint128_t, khval_t, 1, kh_int128_hash_func, kh_int128_hash_equal)
 
@@ -19,20 +25,56 @@
     KHASH_INIT(name, __uint128_t, char, 0, kh_int128_hash_func, kh_int128_hash_equal)
 
 #define KHASH_MAP_INIT_INT256(name, khval_t)								\
-	KHASH_INIT(name, uint256_t, khval_t, 1, kh_int256_hash_func, kh_int256_hash_equal)
+	KHASH_INIT(name, kmer256_t, khval_t, 1, kh_int256_hash_func, kh_int256_hash_equal)
 
 #define KHASH_SET_INIT_INT256(name)										\
-	KHASH_INIT(name, uint256_t, char, 0, kh_int256_hash_func, kh_int256_hash_equal)
+	KHASH_INIT(name, kmer256_t, char, 0, kh_int256_hash_func, kh_int256_hash_equal)
+
+/// Hash the multi-word k-mer for khash.
+template <int W>
+inline khint_t kh_words_hash_func(const kmer_words<W> &key) {
+    uint64_t hash = 0;
+    for (int i = 0; i < W; ++i) hash = (hash ^ key.words[i]) * 0x9E3779B97F4A7C15ULL;
+    return hash ^ (hash >> 32);
+}
+#define kh_words_hash_equal(a, b) ((a) == (b))
+
+#define KHASH_MAP_INIT_WORDS(name, type, khval_t)								\
+	KHASH_INIT(name, type, khval_t, 1, kh_words_hash_func, kh_words_hash_equal)
 
+#define KHASH_SET_INIT_WORDS(name, type)										\
+	KHASH_INIT(name, type, char, 0, kh_words_hash_func, kh_words_hash_equal)
+
+// Use multiple 64-bit words for k-mers which do not fit into 256 bits.
+KHASH_SET_INIT_WORDS(S320, kmer320_t)
+KHASH_MAP_INIT_WORDS(P320, kmer320_t, size_t)
+KHASH_MAP_INIT_WORDS(C320, kmer320_t, uint8_t)
+KHASH_SET_INIT_WORDS(S384, kmer384_t)
+KHASH_MAP_INIT_WORDS(P384, kmer384_t, size_t)
+KHASH_MAP_INIT_WORDS(C384, kmer384_t, uint8_t)
+KHASH_SET_INIT_WORDS(S448, kmer448_t)
+KHASH_MAP_INIT_WORDS(P448, kmer448_t, size_t)
+KHASH_MAP_INIT_WORDS(C448, kmer448_t, uint8_t)
+KHASH_SET_INIT_WORDS(S512, kmer512_t)
+KHASH_MAP_INIT_WORDS(P512, kmer512_t, size_t)
+KHASH_MAP_INIT_WORDS(C512, kmer512_t, uint8_t)
 // Use 128-bit integers for extra large k-mers to allow for larger k.
 KHASH_SET_INIT_INT256(S256)
 KHASH_MAP_INIT_INT256(P256, size_t)
+KHASH_MAP_INIT_INT256(C256, uint8_t)
 // Use 128-bit integers for large k-mers to allow for larger k.
 KHASH_SET_INIT_INT128(S128)
 KHASH_MAP_INIT_INT128(P128, size_t)
+KHASH_MAP_INIT_INT128(C128, uint8_t)
 // Use 64-bits integers for small k-mers for faster operations and less memory usage.
 KHASH_SET_INIT_INT64(S64)
 KHASH_MAP_INIT_INT64(P64, size_t)
+// Counters of k-mer occurrences with one byte per k-mer.
+KHASH_MAP_INIT_INT64(C64, uint8_t)
+// Use 32-bit integers for k <= 16 to halve the memory; they are hashed as 64-bit integers as the identity is poor.
+KHASH_INIT(S32, kmer32_t, char, 0, kh_int64_hash_func, kh_int_hash_equal)
+KHASH_INIT(P32, kmer32_t, size_t, 1, kh_int64_hash_func, kh_int_hash_equal)
+KHASH_INIT(C32, kmer32_t, uint8_t, 1, kh_int64_hash_func, kh_int_hash_equal)
 
 #define INIT_KHASH_WRAPPER(type) \
     struct kmer_dict##type##_t { \
@@ -51,6 +93,12 @@ KHASH_MAP_INIT_INT64(P64, size_t)
         inline void kh_destroy_set(kh_S##type##_t *set) { \
             kh_destroy_S##type(set); \
         }                        \
+        inline void kh_resize_set(kh_S##type##_t *set, khint_t size) { \
+            kh_resize_S##type(set, size); \
+        }                        \
+        inline void kh_prefetch_set(kh_S##type##_t *set, kmer##type##_t key) { \
+            kh_prefetch_S##type(set, key); \
+        }                        \
         inline kh_P##type##_t *kh_init_map() { \
             return kh_init_P##type(); \
         }                         \
@@ -72,11 +120,73 @@ KHASH_MAP_INIT_INT64(P64, size_t)
         inline void kh_resize_map(kh_P##type##_t *map, khint_t size) { \
             kh_resize_P##type(map, size); \
         }                        \
+        inline void kh_prefetch_map(kh_P##type##_t *map, kmer##type##_t key) { \
+            kh_prefetch_P##type(map, key); \
+        }                        \
+        inline kh_C##type##_t *kh_init_counter() { \
+            return kh_init_C##type(); \
+        }                         \
+        inline khint_t kh_put_to_counter(kh_C##type##_t *counter, kmer##type##_t key, int *ret) { \
+            return kh_put_C##type(counter, key, ret); \
+        }                        \
+        inline void kh_destroy_counter(kh_C##type##_t *counter) { \
+            kh_destroy_C##type(counter); \
+        }                        \
     };
 
+INIT_KHASH_WRAPPER(32)
 INIT_KHASH_WRAPPER(64)
 INIT_KHASH_WRAPPER(128)
 INIT_KHASH_WRAPPER(256)
+INIT_KHASH_WRAPPER(320)
+INIT_KHASH_WRAPPER(384)
+INIT_KHASH_WRAPPER(448)
+INIT_KHASH_WRAPPER(512)
+
+/// Fold the k-mer into 64 bits.
+inline uint64_t FoldKMer(kmer32_t kMer) {
+    return kMer;
+}
+
+/// Fold the k-mer into 64 bits.
+inline uint64_t FoldKMer(kmer64_t kMer) {
+    return kMer;
+}
+
+/// Fold the k-mer into 64 bits.
+inline uint64_t FoldKMer(kmer128_t kMer) {
+    return (uint64_t)kMer ^ (uint64_t)(kMer >> 64);
+}
+
+/// Fold the k-mer into 64 bits.
+inline uint64_t FoldKMer(kmer256_t kMer) {
+    return FoldKMer(kMer.lo) ^ FoldKMer(kMer.hi);
+}
+
+/// Fold the k-mer into 64 bits.
+template <int W>
+inline uint64_t FoldKMer(const kmer_words<W> &kMer) {
+    uint64_t folded = 0;
+    for (int i = 0; i < W; ++i) folded ^= kMer.words[i];
+    return folded;
+}
+
+/// Mix the bits of the 64-bit value so that each output bit depends on all the input bits.
+inline uint64_t MixHash(uint64_t value) {
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+/// Return the index of the shard the k-mer belongs to.
+/// The upper bits of a multiplicative hash are used so that the shard does not correlate with the khash bucket.
+template <typename kmer_t>
+inline size_t KMerShard(kmer_t kMer, size_t shards) {
+    return ((FoldKMer(kMer) * 0x9E3779B97F4A7C15ULL) >> 32) % shards;
+}
 
 /// Determine whether the k-mer or its reverse complement is present.
 template <typename kmer_t, typename kh_S_t, typename kh_wrapper_t>
@@ -100,15 +210,16 @@ void eraseKMer(kh_S_t *kMers, kh_wrapper_t wrapper, kmer_t kMer, int k, bool com
     }
 }
 
-/// Return the next k-mer in the k-mer set and update the index.
+/// Find the next k-mer in the k-mer set and update the index. Return false if there are no more k-mers.
+/// No k-mer value is used as a sentinel since for k = 32 with 64-bit k-mers every value is a valid k-mer.
 template <typename kmer_t, typename kh_S_t>
-kmer_t nextKMer(kh_S_t *kMers, [[maybe_unused]] kmer_t _, size_t &lastIndex) {
+bool nextKMer(kh_S_t *kMers, kmer_t &kMer, size_t &lastIndex) {
     for (size_t i = kh_begin(kMers) + lastIndex; i != kh_end(kMers); ++i, ++lastIndex) {
         if (!kh_exist(kMers, i)) continue;
-        return kh_key(kMers, i);
+        kMer = kh_key(kMers, i);
+        return true;
     }
-    // No more k-mers.
-    return -1;
+    return false;
 }
 
 /// Construct a vector of the k-mer set in an arbitrary order.
@@ -123,6 +234,43 @@ std::vector<kmer_t> kMersToVec(kh_S_t *kMers, [[maybe_unused]] kmer_t _) {
     return res;
 }
 
+/// Construct a vector of the k-mers from disjoint shards in an arbitrary order.
+template <typename kmer_t, typename kh_S_t>
+std::vector<kmer_t> kMersToVec(std::vector<kh_S_t*> &shards, [[maybe_unused]] kmer_t _) {
+    size_t size = 0;
+    for (auto shard : shards) size += kh_size(shard);
+    std::vector<kmer_t> res(size);
+    size_t index = 0;
+    for (auto shard : shards) {
+        for (auto i = kh_begin(shard); i != kh_end(shard); ++i) {
+            if (!kh_exist(shard, i)) continue;
+            res[index++] = kh_key(shard, i);
+        }
+    }
+    return res;
+}
+
+/// Merge disjoint shards into a single k-mer set and destroy them, each as soon as it is drained.
+/// The shards are iterated by nextKMer, so they can be any sets which the wrapper provides.
+template <typename kh_S_t, typename kh_wrapper_t>
+kh_S_t *MergeShards(std::vector<kh_S_t*> &shards, kh_wrapper_t wrapper) {
+    if (shards.size() == 1) return shards[0];
+    size_t size = 0;
+    for (auto shard : shards) size += kh_size(shard);
+    auto *kMers = wrapper.kh_init_set();
+    wrapper.kh_resize_set(kMers, size * 100 / 77 + 1);
+    for (auto shard : shards) {
+        std::remove_reference_t<decltype(kh_key(shard, 0))> kMer;
+        for (size_t lastIndex = 0; nextKMer(shard, kMer, lastIndex); ++lastIndex) {
+            int ret;
+            wrapper.kh_put_to_set(kMers, kMer, &ret);
+        }
+        wrapper.kh_destroy_set(shard);
+    }
+    shards.clear();
+    return kMers;
+}
+
 /// Add an interval with given index to the given k-mer.
 ///
 /// [intervalsForKMer] store the intervals and [intervals] maps the k-mer to the index in [intervalsForKMer].
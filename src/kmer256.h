@@ -0,0 +1,128 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+/// Unsigned 256-bit integer of two 128-bit lanes for k-mers with 64 <= k < 128.
+/// Unlike a general big-integer class, it only implements the operations used on k-mers
+/// and the shifts select between the lanes without branches.
+struct kmer256_t {
+    __uint128_t lo, hi;
+
+    kmer256_t() = default;
+
+    constexpr kmer256_t(__uint128_t lo, __uint128_t hi) : lo(lo), hi(hi) {}
+
+    /// Construct from an integer; negative values are sign-extended so that kmer256_t(-1) has all bits set.
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    constexpr kmer256_t(T value) : lo(__uint128_t(value)), hi(0) {
+        if constexpr (std::is_signed_v<T>) hi = value < 0 ? ~__uint128_t(0) : 0;
+    }
+
+    constexpr kmer256_t(__uint128_t value) : lo(value), hi(0) {}
+
+    /// Return the lowest bits converted to the integer type.
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    explicit operator T() const {
+        return T(lo);
+    }
+
+    explicit operator __uint128_t() const {
+        return lo;
+    }
+
+    explicit operator bool() const {
+        return lo | hi;
+    }
+
+    /// Return the mask of the lowest bits, which may be 0 to 256.
+    static kmer256_t LowMask(int bits) {
+        __uint128_t loMask = bits >= 128 ? ~__uint128_t(0) : (__uint128_t(1) << (bits & 127)) - 1;
+        __uint128_t hiMask = bits <= 128 ? 0 : bits >= 256 ? ~__uint128_t(0) : (__uint128_t(1) << (bits & 127)) - 1;
+        return {loMask, hiMask};
+    }
+
+    friend kmer256_t operator<<(const kmer256_t &value, int shift) {
+        int inLane = shift & 127;
+        // Equal to lo >> (128 - inLane) but also defined for inLane = 0.
+        __uint128_t carry = (value.lo >> 1) >> (127 - inLane);
+        __uint128_t lo = value.lo << inLane, hi = (value.hi << inLane) | carry;
+        if (shift >= 256) return {0, 0};
+        return shift & 128 ? kmer256_t(0, lo) : kmer256_t(lo, hi);
+    }
+
+    friend kmer256_t operator>>(const kmer256_t &value, int shift) {
+        int inLane = shift & 127;
+        // Equal to hi << (128 - inLane) but also defined for inLane = 0.
+        __uint128_t carry = (value.hi << 1) << (127 - inLane);
+        __uint128_t lo = (value.lo >> inLane) | carry, hi = value.hi >> inLane;
+        if (shift >= 256) return {0, 0};
+        return shift & 128 ? kmer256_t(hi, 0) : kmer256_t(lo, hi);
+    }
+
+    friend kmer256_t operator<<(const kmer256_t &value, const kmer256_t &shift) {
+        return value << int(shift.hi ? 256 : shift.lo >= 256 ? 256 : int(shift.lo));
+    }
+
+    friend kmer256_t operator>>(const kmer256_t &value, const kmer256_t &shift) {
+        return value >> int(shift.hi ? 256 : shift.lo >= 256 ? 256 : int(shift.lo));
+    }
+
+    friend kmer256_t operator&(const kmer256_t &a, const kmer256_t &b) {
+        return {a.lo & b.lo, a.hi & b.hi};
+    }
+
+    friend kmer256_t operator|(const kmer256_t &a, const kmer256_t &b) {
+        return {a.lo | b.lo, a.hi | b.hi};
+    }
+
+    friend kmer256_t operator^(const kmer256_t &a, const kmer256_t &b) {
+        return {a.lo ^ b.lo, a.hi ^ b.hi};
+    }
+
+    friend kmer256_t operator~(const kmer256_t &a) {
+        return {~a.lo, ~a.hi};
+    }
+
+    friend kmer256_t operator+(const kmer256_t &a, const kmer256_t &b) {
+        __uint128_t lo = a.lo + b.lo;
+        return {lo, a.hi + b.hi + (lo < a.lo)};
+    }
+
+    friend kmer256_t operator-(const kmer256_t &a, const kmer256_t &b) {
+        return {a.lo - b.lo, a.hi - b.hi - (a.lo < b.lo)};
+    }
+
+    friend kmer256_t operator-(const kmer256_t &a) {
+        return kmer256_t(0) - a;
+    }
+
+    kmer256_t &operator++() {
+        hi += !++lo;
+        return *this;
+    }
+
+    kmer256_t &operator<<=(int shift) { return *this = *this << shift; }
+    kmer256_t &operator>>=(int shift) { return *this = *this >> shift; }
+    kmer256_t &operator&=(const kmer256_t &other) { return *this = *this & other; }
+    kmer256_t &operator|=(const kmer256_t &other) { return *this = *this | other; }
+    kmer256_t &operator^=(const kmer256_t &other) { return *this = *this ^ other; }
+    kmer256_t &operator+=(const kmer256_t &other) { return *this = *this + other; }
+    kmer256_t &operator-=(const kmer256_t &other) { return *this = *this - other; }
+
+    friend bool operator==(const kmer256_t &a, const kmer256_t &b) {
+        return !((a.lo ^ b.lo) | (a.hi ^ b.hi));
+    }
+
+    friend bool operator!=(const kmer256_t &a, const kmer256_t &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const kmer256_t &a, const kmer256_t &b) {
+        return a.hi != b.hi ? a.hi < b.hi : a.lo < b.lo;
+    }
+
+    friend bool operator>(const kmer256_t &a, const kmer256_t &b) { return b < a; }
+    friend bool operator<=(const kmer256_t &a, const kmer256_t &b) { return !(b < a); }
+    friend bool operator>=(const kmer256_t &a, const kmer256_t &b) { return !(a < b); }
+};
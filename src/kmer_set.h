@@ -0,0 +1,97 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "parser.h"
+
+/// The first bytes of every binary k-mer set file.
+constexpr char KMER_SET_MAGIC[8] = {'K', 'M', 'C', 'A', 'M', 'E', 'L', '1'};
+
+/// The header of the binary k-mer set file, which is followed by count sorted k-mers of width bytes each.
+struct KMerSetHeader {
+    char magic[8];
+    uint32_t k;
+    uint8_t complements;
+    uint8_t width;
+    uint16_t reserved;
+    uint64_t count;
+};
+static_assert(sizeof(KMerSetHeader) == 24, "The k-mer set header must not contain padding.");
+
+/// Determine whether the file at the given path is a binary k-mer set file.
+bool IsKMerSetFile(const std::string &path) {
+    if (path == "-") return false;
+    char magic[sizeof(KMER_SET_MAGIC)];
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(magic, sizeof(magic))) return false;
+    return !memcmp(magic, KMER_SET_MAGIC, sizeof(magic));
+}
+
+/// Read the header of the binary k-mer set file and return whether it is complete.
+bool ReadKMerSetHeader(const std::string &path, KMerSetHeader &header) {
+    std::ifstream file(path, std::ios::binary);
+    return file.read((char*)&header, sizeof(header)) && !memcmp(header.magic, KMER_SET_MAGIC, sizeof(KMER_SET_MAGIC));
+}
+
+/// Determine whether the binary k-mer set file with the given header holds exactly count k-mers of the type kmer_t,
+/// so that LoadKMerSet can load it.
+template <typename kmer_t>
+bool IsCompleteKMerSetFile(const std::string &path, const KMerSetHeader &header, [[maybe_unused]] kmer_t _) {
+    std::error_code error;
+    uint64_t size = std::filesystem::file_size(path, error);
+    if (error || header.width != sizeof(kmer_t) || size < sizeof(header)) return false;
+    // Compare by division, as the count of a corrupted header may overflow when multiplied.
+    return (size - sizeof(header)) % sizeof(kmer_t) == 0 && (size - sizeof(header)) / sizeof(kmer_t) == header.count;
+}
+
+/// Sort the k-mers and write them in the binary k-mer set format.
+template <typename kmer_t>
+void WriteKMerSet(std::vector<kmer_t> &kMers, int k, bool complements, std::ostream &of) {
+    std::sort(kMers.begin(), kMers.end());
+    KMerSetHeader header;
+    memcpy(header.magic, KMER_SET_MAGIC, sizeof(KMER_SET_MAGIC));
+    header.k = k;
+    header.complements = complements;
+    header.width = sizeof(kmer_t);
+    header.reserved = 0;
+    header.count = kMers.size();
+    of.write((const char*)&header, sizeof(header));
+    of.write((const char*)kMers.data(), kMers.size() * sizeof(kmer_t));
+}
+
+/// Load the sorted k-mers from the binary k-mer set file by mapping it into memory.
+template <typename kmer_t>
+std::vector<kmer_t> LoadKMerSet(const std::string &path, [[maybe_unused]] kmer_t _) {
+    MappedFile file = MapFile(path);
+    KMerSetHeader header;
+    if (file.size < sizeof(header)) {
+        UnmapFile(file);
+        throw std::invalid_argument("'" + path + "' is not a k-mer set file");
+    }
+    memcpy(&header, file.data, sizeof(header));
+    if (header.width != sizeof(kmer_t) || file.size != sizeof(header) + header.count * sizeof(kmer_t)) {
+        UnmapFile(file);
+        throw std::invalid_argument("k-mer set file '" + path + "' is corrupted");
+    }
+    std::vector<kmer_t> kMers(header.count);
+    memcpy((void*)kMers.data(), file.data + sizeof(header), header.count * sizeof(kmer_t));
+    UnmapFile(file);
+    return kMers;
+}
+
+/// Insert the k-mers from the vector into an empty set sized for them.
+template <typename kmer_t, typename kh_S_t, typename kh_wrapper_t>
+void KMersToSet(kh_S_t *kMers, kh_wrapper_t wrapper, std::vector<kmer_t> &kMerVec) {
+    wrapper.kh_resize_set(kMers, kMerVec.size() * 100 / 77 + 1);
+    for (auto &&kMer : kMerVec) {
+        int ret;
+        wrapper.kh_put_to_set(kMers, kMer, &ret);
+    }
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+/// Unsigned integer of W 64-bit words for k-mers which do not fit into 256 bits.
+/// It supports the integer operations used on k-mers, so that all the k-mer templates work with it.
+/// The words are stored from the least significant one and all the loops are over the compile-time W.
+template <int W>
+struct kmer_words {
+    uint64_t words[W];
+
+    kmer_words() = default;
+
+    /// Construct from an integer; negative values are sign-extended so that kmer_words(-1) has all bits set.
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    kmer_words(T value) {
+        words[0] = uint64_t(value);
+        uint64_t fill = 0;
+        if constexpr (std::is_signed_v<T>) fill = value < 0 ? ~uint64_t(0) : 0;
+        for (int i = 1; i < W; ++i) words[i] = fill;
+    }
+
+    kmer_words(__uint128_t value) {
+        words[0] = uint64_t(value);
+        words[1] = uint64_t(value >> 64);
+        for (int i = 2; i < W; ++i) words[i] = 0;
+    }
+
+    /// Return the lowest bits converted to the integer type.
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    explicit operator T() const {
+        return T(words[0]);
+    }
+
+    explicit operator bool() const {
+        uint64_t any = 0;
+        for (int i = 0; i < W; ++i) any |= words[i];
+        return any;
+    }
+
+    friend kmer_words operator<<(kmer_words value, kmer_words shift) {
+        return value.ShiftLeft(uint64_t(shift.words[0]));
+    }
+
+    friend kmer_words operator>>(kmer_words value, kmer_words shift) {
+        return value.ShiftRight(uint64_t(shift.words[0]));
+    }
+
+    friend kmer_words operator&(kmer_words a, const kmer_words &b) {
+        for (int i = 0; i < W; ++i) a.words[i] &= b.words[i];
+        return a;
+    }
+
+    friend kmer_words operator|(kmer_words a, const kmer_words &b) {
+        for (int i = 0; i < W; ++i) a.words[i] |= b.words[i];
+        return a;
+    }
+
+    friend kmer_words operator^(kmer_words a, const kmer_words &b) {
+        for (int i = 0; i < W; ++i) a.words[i] ^= b.words[i];
+        return a;
+    }
+
+    friend kmer_words operator~(kmer_words a) {
+        for (int i = 0; i < W; ++i) a.words[i] = ~a.words[i];
+        return a;
+    }
+
+    friend kmer_words operator+(kmer_words a, const kmer_words &b) {
+        uint64_t carry = 0;
+        for (int i = 0; i < W; ++i) {
+            uint64_t sum = a.words[i] + carry;
+            carry = sum < carry;
+            a.words[i] = sum + b.words[i];
+            carry += a.words[i] < sum;
+        }
+        return a;
+    }
+
+    friend kmer_words operator-(kmer_words a, const kmer_words &b) {
+        uint64_t borrow = 0;
+        for (int i = 0; i < W; ++i) {
+            uint64_t difference = a.words[i] - borrow;
+            borrow = difference > a.words[i];
+            borrow += difference < b.words[i];
+            a.words[i] = difference - b.words[i];
+        }
+        return a;
+    }
+
+    friend kmer_words operator-(const kmer_words &a) {
+        return kmer_words(0) - a;
+    }
+
+    kmer_words &operator++() {
+        for (int i = 0; i < W && !++words[i]; ++i) {}
+        return *this;
+    }
+
+    kmer_words &operator<<=(const kmer_words &shift) { return *this = *this << shift; }
+    kmer_words &operator>>=(const kmer_words &shift) { return *this = *this >> shift; }
+    kmer_words &operator&=(const kmer_words &other) { return *this = *this & other; }
+    kmer_words &operator|=(const kmer_words &other) { return *this = *this | other; }
+    kmer_words &operator^=(const kmer_words &other) { return *this = *this ^ other; }
+    kmer_words &operator+=(const kmer_words &other) { return *this = *this + other; }
+    kmer_words &operator-=(const kmer_words &other) { return *this = *this - other; }
+
+    friend bool operator==(const kmer_words &a, const kmer_words &b) {
+        uint64_t difference = 0;
+        for (int i = 0; i < W; ++i) difference |= a.words[i] ^ b.words[i];
+        return !difference;
+    }
+
+    friend bool operator!=(const kmer_words &a, const kmer_words &b) {
+        return !(a == b);
+    }
+
+    friend bool operator<(const kmer_words &a, const kmer_words &b) {
+        for (int i = W - 1; i > 0; --i) {
+            if (a.words[i] != b.words[i]) return a.words[i] < b.words[i];
+        }
+        return a.words[0] < b.words[0];
+    }
+
+    friend bool operator>(const kmer_words &a, const kmer_words &b) { return b < a; }
+    friend bool operator<=(const kmer_words &a, const kmer_words &b) { return !(b < a); }
+    friend bool operator>=(const kmer_words &a, const kmer_words &b) { return !(a < b); }
+
+private:
+    kmer_words ShiftLeft(uint64_t shift) const {
+        kmer_words result(0);
+        if (shift >= 64 * W) return result;
+        int wordShift = shift / 64, bitShift = shift % 64;
+        for (int i = W - 1; i >= wordShift; --i) {
+            result.words[i] = words[i - wordShift] << bitShift;
+            if (bitShift && i > wordShift) result.words[i] |= words[i - wordShift - 1] >> (64 - bitShift);
+        }
+        return result;
+    }
+
+    kmer_words ShiftRight(uint64_t shift) const {
+        kmer_words result(0);
+        if (shift >= 64 * W) return result;
+        int wordShift = shift / 64, bitShift = shift % 64;
+        for (int i = 0; i + wordShift < W; ++i) {
+            result.words[i] = words[i + wordShift] >> bitShift;
+            if (bitShift && i + wordShift + 1 < W) result.words[i] |= words[i + wordShift + 1] << (64 - bitShift);
+        }
+        return result;
+    }
+};
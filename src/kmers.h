@@ -4,13 +4,19 @@
 #include <iostream>
 #include <cstdint>
 
-#include "uint256_t/uint256_t.h"
+#include "kmer256.h"
+#include "kmer_words.h"
 
 #include "ac/kmers_ac.h"
 
 typedef __uint128_t kmer128_t;
 typedef uint64_t kmer64_t;
-typedef uint256_t kmer256_t;
+typedef uint32_t kmer32_t;
+// Multi-word k-mers for k up to 255.
+typedef kmer_words<5> kmer320_t;
+typedef kmer_words<6> kmer384_t;
+typedef kmer_words<7> kmer448_t;
+typedef kmer_words<8> kmer512_t;
 
 static const uint8_t nucleotideToInt[] = {
 		4, 4, 4, 4,  4, 4, 4, 4,  4, 4, 4, 4,  4, 4, 4, 4,
@@ -31,16 +37,34 @@ static const uint8_t nucleotideToInt[] = {
 		4, 4, 4, 4,  4, 4, 4, 4,  4, 4, 4, 4,  4, 4, 4, 4
 	};
 
+/// Return the mask of the lowest 2k bits, which has all the bits set if the k-mer fills the whole integer.
+template <typename kmer_t>
+inline kmer_t KMerMask(int k) {
+    return 2 * k >= int(sizeof(kmer_t) * 8) ? kmer_t(-1) : (kmer_t(1) << (2 * k)) - kmer_t(1);
+}
+
 /// Compute the prefix of size d of the given k-mer.
 template <typename kmer_t>
 kmer_t BitPrefix(kmer_t kMer, int k, int d) {
+    // The empty prefix of a k-mer which fills the whole integer would need a shift by its whole width.
+    if ((k - d) << 1 >= int(sizeof(kmer_t) * 8)) return kmer_t(0);
     return kMer >> ((k - d) << kmer_t(1));
 }
 
 /// Compute the suffix of size d of the given k-mer.
 template <typename kmer_t>
 kmer_t BitSuffix(kmer_t kMer, int d) {
-    return kMer & ((kmer_t(1) << (d << kmer_t(1))) - kmer_t(1));
+    return kMer & KMerMask<kmer_t>(d);
+}
+
+/// Compute the prefix of size d of the given k-mer.
+inline kmer256_t BitPrefix(kmer256_t kMer, int k, int d) {
+    return kMer >> ((k - d) << 1);
+}
+
+/// Compute the suffix of size d of the given k-mer.
+inline kmer256_t BitSuffix(kmer256_t kMer, int d) {
+    return kMer & kmer256_t::LowMask(d << 1);
 }
 
 /// Checkered mask. cmask<uint16_t, 1> is every other bit on
@@ -56,6 +80,17 @@ struct cmask<U, len, 0> {
     static const U v = 0;
 };
 
+/// Compute the reverse complement of a word.
+/// Copyright: Jellyfish GPL-3.0
+inline kmer32_t word_reverse_complement(kmer32_t w) {
+    typedef kmer32_t U;
+    w = ((w >> 2)  & cmask<U, 2 >::v) | ((w & cmask<U, 2 >::v) << 2);
+    w = ((w >> 4)  & cmask<U, 4 >::v) | ((w & cmask<U, 4 >::v) << 4);
+    w = ((w >> 8)  & cmask<U, 8 >::v) | ((w & cmask<U, 8 >::v) << 8);
+    w = ( w >> 16                   ) | ( w                    << 16);
+    return ((U)-1) - w;
+}
+
 /// Compute the reverse complement of a word.
 /// Copyright: Jellyfish GPL-3.0
 inline kmer64_t word_reverse_complement(kmer64_t w) {
@@ -83,15 +118,26 @@ inline kmer128_t word_reverse_complement(kmer128_t w) {
 
 /// Compute the reverse complement of a word.
 inline kmer256_t word_reverse_complement(kmer256_t w) {
-    kmer128_t low = word_reverse_complement(w.lower());
-    kmer128_t high = word_reverse_complement(w.upper());
-    return kmer256_t(low, high);
+    return kmer256_t(word_reverse_complement(w.hi), word_reverse_complement(w.lo));
+}
+
+/// Compute the reverse complement of a multi-word k-mer by reversing the order of its words.
+template <int W>
+inline kmer_words<W> word_reverse_complement(const kmer_words<W> &w) {
+    kmer_words<W> result;
+    for (int i = 0; i < W; ++i) result.words[W - 1 - i] = word_reverse_complement(w.words[i]);
+    return result;
 }
 
 /// Compute the reverse complement of the given k-mer.
 template <typename kmer_t>
 kmer_t ReverseComplement(kmer_t kMer, int k) {
-    return (((kmer_t)word_reverse_complement(kMer)) >> ((sizeof(kMer)<<3) - (k << 1))) & ((kmer_t(1) << (k << 1)) - kmer_t(1));
+    return (((kmer_t)word_reverse_complement(kMer)) >> ((sizeof(kMer)<<3) - (k << 1))) & KMerMask<kmer_t>(k);
+}
+
+/// Compute the reverse complement of the given k-mer.
+inline kmer256_t ReverseComplement(kmer256_t kMer, int k) {
+    return (word_reverse_complement(kMer) >> (256 - (k << 1))) & kmer256_t::LowMask(k << 1);
 }
 
 const char letters[4] {'A', 'C', 'G', 'T'};
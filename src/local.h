@@ -98,10 +98,8 @@ void NextGeneralizedSimplitig(kh_S_t *kMers, kh_wrapper_t wrapper, kmer_t begin,
 template <typename kmer_t, typename kh_S_t, typename kh_wrapper_t>
 void Local(kh_S_t *kMers, kh_wrapper_t wrapper, kmer_t _, std::ostream& of, int k, int d_max, bool complements) {
     size_t lastIndex = 0;
-    while(true) {
-        kmer_t begin = nextKMer(kMers, _, lastIndex);
-        // No more k-mers.
-        if (begin == kmer_t(-1)) return;
+    kmer_t begin = _;
+    while (nextKMer(kMers, begin, lastIndex)) {
         NextGeneralizedSimplitig(kMers, wrapper, begin, of,  k, d_max, complements);
     }
 }
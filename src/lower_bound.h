@@ -3,13 +3,26 @@
 #include "global.h"
 #include "kmers.h"
 
-/// Return the length of the cycle cover which lower bounds the superstring length.
-template <typename kmer_t, typename kh_wrapper_t>
-size_t LowerBoundLength(kh_wrapper_t wrapper, std::vector<kmer_t> kMers, int k, bool complements) {
-    auto cycle_cover = OverlapHamiltonianPath(wrapper, kMers, k, complements, true);
+/// Return the length of the given cycle cover, which lower bounds the superstring length.
+inline size_t CycleCoverLength(const overlapPath &cycle_cover, int k, bool complements) {
     size_t res = 0;
     for (auto &overlap : cycle_cover.second) {
         res += size_t(k) - size_t(overlap);
     }
     return res / (1 + complements);
-}
\ No newline at end of file
+}
+
+/// Return the length of the cycle cover which lower bounds the superstring length.
+/// The k-mers are either a std::vector or a PackedKMerArray.
+/// If checkpoint is given, the progress is saved there and a resumed run continues from it.
+template <typename kmers_t, typename kh_wrapper_t>
+size_t LowerBoundLength(kh_wrapper_t wrapper, kmers_t &kMers, int k, bool complements, int threads = 1, size_t maxMemory = 0,
+                        GlobalCheckpoint *checkpoint = nullptr) {
+    return CycleCoverLength(OverlapHamiltonianPath(wrapper, kMers, k, complements, true, threads, maxMemory, checkpoint), k, complements);
+}
+
+/// Return the same lower bound as LowerBoundLength computed by merge-joins instead of hashing.
+template <typename kmers_t>
+size_t LowerBoundLengthMergeJoin(kmers_t &kMers, int k, bool complements) {
+    return CycleCoverLength(OverlapHamiltonianPathMergeJoin(kMers, k, complements, true), k, complements);
+}
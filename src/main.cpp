@@ -1,7 +1,9 @@
 #include <iostream>
 #include <string>
+#include <memory>
 
 #include "unistd.h"
+#include "getopt.h"
 #include "version.h"
 #include "ac/global_ac.h"
 #include "global.h"
@@ -11,6 +13,10 @@
 #include "ac/parser_ac.h"
 #include "ac/streaming.h"
 #include "khash_utils.h"
+#include "external.h"
+#include "kmer_set.h"
+#include "compact_set.h"
+#include "swiss_table.h"
 
 #include <iostream>
 #include <string>
@@ -22,153 +28,440 @@
 int Help() {
     std::cerr << "KmerCamel version " << VERSION << std::endl;
     std::cerr << "Accepted arguments:" << std::endl;
-    std::cerr << "  -p path_to_fasta - required; valid path to fasta file (can be gziped)" << std::endl;
-    std::cerr << "  -k k_value       - required; integer value for k (up to 127)" << std::endl;
+    std::cerr << "  -p path_to_fasta - required; valid path to fasta file (can be gziped); can be repeated for global and local" << std::endl;
+    std::cerr << "  -p @list_file    - read the paths to fasta files from the given file, one per line" << std::endl;
+    std::cerr << "  -k k_value       - required; integer value for k (up to 255)" << std::endl;
     std::cerr << "  -a algorithm     - the algorithm to be run [global (default), globalAC, local, localAC, streaming]" << std::endl;
     std::cerr << "  -o output_path   - if not specified, the output is printed to stdout" << std::endl;
     std::cerr << "  -d d_value       - integer value for d_max; default 5" << std::endl;
     std::cerr << "  -c               - treat k-mer and its reverse complement as equal" << std::endl;
     std::cerr << "  -m               - turn off the memory optimizations for global" << std::endl;
     std::cerr << "  -l               - compute the cycle cover lower bound instead of masked superstring" << std::endl;
+    std::cerr << "  -t threads       - number of threads used for reading k-mers in global and local and for global; default 1" << std::endl;
+    std::cerr << "  -T tmp_dir       - deduplicate k-mers for global and local on disk in the given directory to save memory" << std::endl;
+    std::cerr << "  --min-count n    - use only k-mers occurring at least n times (up to 255) for global and local; default 1" << std::endl;
+    std::cerr << "  --hash-free      - read k-mers for global (or local with --compact-set) by sorting instead of a hash table" << std::endl;
+    std::cerr << "  --bloom-memory m - use only k-mers occurring at least twice for global and local," << std::endl;
+    std::cerr << "                     filtering the first occurrences by a Bloom filter of m MB; may keep some other k-mers" << std::endl;
+    std::cerr << "  --compact-set    - store the k-mers for local in a compact set using less memory;" << std::endl;
+    std::cerr << "                     it is sized by a HyperLogLog pre-pass, so uncompressed files are read twice," << std::endl;
+    std::cerr << "                     and it is filled by one thread at a time, so t speeds up only the parsing" << std::endl;
+    std::cerr << "  --swiss-table    - use SIMD-probed Swiss tables instead of khash in global and local" << std::endl;
+    std::cerr << "  --presize        - estimate the number of k-mers by HyperLogLog in a pre-pass for global and local" << std::endl;
+    std::cerr << "                     and size the hash tables up front; gzipped files are only sampled" << std::endl;
+    std::cerr << "  --max-memory g   - split the prefixes in global into as few batches as fit into g GB, planned again for each overlap;" << std::endl;
+    std::cerr << "                     the k-mers are still read before and may need more memory" << std::endl;
+    std::cerr << "  --merge-join     - run global by merge-joining sorted arrays of prefixes and suffixes instead of hashing;" << std::endl;
+    std::cerr << "                     gives the same result and is faster on large inputs but uses more memory; single-threaded" << std::endl;
+    std::cerr << "  --checkpoint dir - save the progress of global in the given directory after each overlap" << std::endl;
+    std::cerr << "  --resume         - resume the interrupted global from the checkpoint; the k-mers are loaded from it, so p can be omitted" << std::endl;
     std::cerr << "  -h               - print help" << std::endl;
     std::cerr << "  -v               - print version" << std::endl;
     std::cerr << "Example usage:       ./kmercamel -p path_to_fasta -k 31 -d 5 -a local -c" << std::endl;
     std::cerr << "Possible algorithms: global globalAC local localAC streaming" << std::endl;
     std::cerr << std::endl;
+    std::cerr << "The path can also point to a k-mer set file saved by `kmercamel save`." << std::endl;
+    std::cerr << std::endl;
     std::cerr << "For optimization of masks use `kmercamel optimize`."  << std::endl;
     std::cerr << "Accepted arguments:" << std::endl;
     std::cerr << "  -p path_to_fasta - required; valid path to fasta file (can be gziped)" << std::endl;
-    std::cerr << "  -k k_value       - required; integer value for k (up to 127)" << std::endl;
+    std::cerr << "  -k k_value       - required; integer value for k (up to 255)" << std::endl;
     std::cerr << "  -a algorithm     - the algorithm to be run [ones (default), runs, runsapprox, zeros]" << std::endl;
     std::cerr << "  -o output_path   - if not specified, the output is printed to stdout" << std::endl;
     std::cerr << "  -c               - treat k-mer and its reverse complement as equal" << std::endl;
+    std::cerr << "  -t threads       - number of threads used for ones and for reading k-mers in zeros; default 1" << std::endl;
     std::cerr << "  -h               - print help" << std::endl;
     std::cerr << "  -v               - print version" << std::endl;
+    std::cerr << std::endl;
+    std::cerr << "For saving the k-mer set in a binary format use `kmercamel save`."  << std::endl;
+    std::cerr << "Accepted arguments:" << std::endl;
+    std::cerr << "  -p path_to_fasta - required; valid path to fasta file (can be gziped)" << std::endl;
+    std::cerr << "  -k k_value       - required; integer value for k (up to 255)" << std::endl;
+    std::cerr << "  -o output_path   - if not specified, the output is printed to stdout" << std::endl;
+    std::cerr << "  -c               - treat k-mer and its reverse complement as equal" << std::endl;
+    std::cerr << "  -t threads       - number of threads used for reading k-mers; default 1" << std::endl;
+    std::cerr << "  -T tmp_dir       - deduplicate k-mers on disk in the given directory to save memory" << std::endl;
+    std::cerr << "  --min-count n    - save only k-mers occurring at least n times (up to 255); default 1" << std::endl;
+    std::cerr << "  --hash-free      - read k-mers by sorting instead of a hash table" << std::endl;
+    std::cerr << "  --bloom-memory m - save only k-mers occurring at least twice using a Bloom filter of m MB" << std::endl;
     return 1;
 }
 
-constexpr int MAX_K = 127;
+constexpr int MAX_K = 255;
+
+/// Options without a short version are identified by values outside of the char range.
+constexpr int MIN_COUNT_OPTION = 256;
+constexpr int BLOOM_MEMORY_OPTION = 257;
+constexpr int HASH_FREE_OPTION = 258;
+constexpr int COMPACT_SET_OPTION = 259;
+constexpr int SWISS_TABLE_OPTION = 260;
+constexpr int PRESIZE_OPTION = 261;
+constexpr int MERGE_JOIN_OPTION = 262;
+constexpr int MAX_MEMORY_OPTION = 263;
+constexpr int CHECKPOINT_OPTION = 264;
+constexpr int RESUME_OPTION = 265;
+const struct option LONG_OPTIONS[] = {
+        {"min-count", required_argument, nullptr, MIN_COUNT_OPTION},
+        {"bloom-memory", required_argument, nullptr, BLOOM_MEMORY_OPTION},
+        {"hash-free", no_argument, nullptr, HASH_FREE_OPTION},
+        {"compact-set", no_argument, nullptr, COMPACT_SET_OPTION},
+        {"swiss-table", no_argument, nullptr, SWISS_TABLE_OPTION},
+        {"presize", no_argument, nullptr, PRESIZE_OPTION},
+        {"merge-join", no_argument, nullptr, MERGE_JOIN_OPTION},
+        {"max-memory", required_argument, nullptr, MAX_MEMORY_OPTION},
+        {"checkpoint", required_argument, nullptr, CHECKPOINT_OPTION},
+        {"resume", no_argument, nullptr, RESUME_OPTION},
+        {nullptr, 0, nullptr, 0},
+};
 
 void Version() {
     std::cerr << VERSION << std::endl;
 }
 
-/// Run KmerCamel with the given parameters.
+/// The options of a run of KmerCamel, as given on the command line.
+struct KmerCamelOptions {
+    std::vector<std::string> paths;
+    int k = 0;
+    int d_max = 5;
+    std::ostream *of = &std::cout;
+    bool complements = false;
+    /// Whether to optimize the mask of a masked superstring instead of computing one.
+    bool masks = false;
+    std::string algorithm = "global";
+    bool optimize_memory = true;
+    bool lower_bound = false;
+    int threads = 1;
+    std::string tmp_dir;
+    /// Whether to save the k-mer set in the binary format instead of computing a superstring.
+    bool save = false;
+    int min_count = 1;
+    int bloom_memory = 0;
+    bool hash_free = false;
+    bool compact_set = false;
+    bool swiss_table = false;
+    bool presize = false;
+    bool merge_join = false;
+    /// The memory limit of global in GB, or 0 if there is none.
+    double max_memory = 0;
+    std::string checkpoint_dir;
+    bool resume = false;
+};
+
+/// Run KmerCamel with the given options.
 template <typename kmer_t, typename kh_wrapper_t>
-int kmercamel(kh_wrapper_t wrapper, kmer_t kmer_type, std::string path, int k, int d_max, std::ostream *of, bool complements, bool masks,
-                    std::string algorithm, bool optimize_memory, bool lower_bound) {
-    if (masks) {
-        int ret = Optimize(wrapper, kmer_type, algorithm, path, *of, k, complements);
+int kmercamel(kh_wrapper_t wrapper, kmer_t kmer_type, const KmerCamelOptions &options) {
+    /* The readers take the paths by reference, so they get a copy. */
+    std::vector<std::string> paths = options.paths;
+    std::string path = paths.empty() ? "" : paths[0];
+    if (options.masks) {
+        int ret = Optimize(wrapper, kmer_type, options.algorithm, path, *options.of, options.k, options.complements, options.threads);
         if (ret) Help();
         return ret;
     }
 
     /* Handle streaming algorithm separately. */
-    if (algorithm == "streaming") {
-        WriteName(k, *of);
-        Streaming(path, *of,  k , complements);
+    if (options.algorithm == "streaming") {
+        WriteName(options.k, *options.of);
+        Streaming(path, *options.of,  options.k , options.complements);
     }
     /* Handle hash table based algorithms separately so that they consume less memory. */
-    else if (algorithm == "global" || algorithm == "local") {
+    else if (options.algorithm == "global" || options.algorithm == "local") {
+        std::vector<kmer_t> kMerVec;
         auto *kMers = wrapper.kh_init_set();
-        ReadKMers(kMers, wrapper, kmer_type, path, k, complements);
-        if (!kh_size(kMers)) {
-            std::cerr << "Path '" << path << "' contains no k-mers." << std::endl;
+        bool sorted = false;
+        /* The compact set is filled while reading or built from the vector of k-mers so that no hash table of all the k-mers is needed. */
+        std::unique_ptr<CompactKMerSet<kmer_t, kh_wrapper_t>> compactKMers;
+        bool toVec = options.algorithm == "global" || options.compact_set;
+        /* With Swiss tables, the k-mers for local are read straight into a Swiss set so that no khash set of all the k-mers is built. */
+        swiss_dict_t<kmer_t> swissWrapper;
+        bool toSwiss = options.swiss_table && options.algorithm == "local";
+        std::unique_ptr<typename swiss_dict_t<kmer_t>::set_t> swissKMers(swissWrapper.kh_init_set());
+        auto readShards = [&](auto setWrapper) {
+            std::vector<decltype(setWrapper.kh_init_set())> shards;
+            size_t expectedKMers = options.presize ? EstimateDistinctKMers(kmer_type, paths, options.k, options.complements) : 0;
+            if (options.min_count > 1) shards = {ReadSolidKMers(wrapper, setWrapper, kmer_type, paths, options.k, options.complements, options.min_count)};
+            else if (options.bloom_memory) shards = {ReadKMersFiltered(setWrapper, kmer_type, paths, options.k, options.complements, size_t(options.bloom_memory) << 20)};
+            else if (paths.size() == 1) shards = ReadKMersSharded(setWrapper, kmer_type, path, options.k, options.complements, options.threads, false, expectedKMers);
+            else shards = ReadKMersFromFiles(setWrapper, kmer_type, paths, options.k, options.complements, options.threads, false, expectedKMers);
+            return shards;
+        };
+        /* A positive limit below a byte still limits the memory, as 0 stands for no limit. */
+        size_t maxMemory = options.max_memory ? std::max(size_t(1), size_t(options.max_memory * (1 << 30))) : 0;
+        std::unique_ptr<GlobalCheckpoint> checkpoint;
+        if (!options.checkpoint_dir.empty()) checkpoint = std::make_unique<GlobalCheckpoint>(options.checkpoint_dir, options.resume);
+        if (options.resume) {
+            /* The k-mers are loaded in the order in which they were saved, so they are neither read nor presorted again. */
+            if (!checkpoint->LoadKMers(kMerVec, options.k, options.complements, options.lower_bound, maxMemory)) {
+                wrapper.kh_destroy_set(kMers);
+                std::cerr << "Checkpoint in '" << options.checkpoint_dir << "' is missing, has an edge log of other k-mers or was not saved with k = " << options.k
+                          << (options.complements ? ", with" : ", without") << " -c," << (options.lower_bound ? " with" : " without") << " -l and "
+                          << (options.max_memory ? "with --max-memory " + std::to_string(options.max_memory) : "without --max-memory") << "." << std::endl;
+                return Help();
+            }
+            sorted = true;
+        } else if (IsKMerSetFile(path)) {
+            KMerSetHeader header;
+            bool readHeader = ReadKMerSetHeader(path, header);
+            if (readHeader && ((int)header.k != options.k || (bool)header.complements != options.complements)) {
+                wrapper.kh_destroy_set(kMers);
+                std::cerr << "K-mer set file '" << path << "' was saved with k = " << header.k
+                          << (header.complements ? " and" : " and without") << " -c." << std::endl;
+                return Help();
+            }
+            if (!readHeader || !IsCompleteKMerSetFile(path, header, kmer_type)) {
+                wrapper.kh_destroy_set(kMers);
+                std::cerr << "K-mer set file '" << path << "' is truncated or corrupted." << std::endl;
+                return Help();
+            }
+            kMerVec = LoadKMerSet(path, kmer_type);
+            sorted = true;
+            if (!toVec) {
+                if (toSwiss) KMersToSet(swissKMers.get(), swissWrapper, kMerVec);
+                else KMersToSet(kMers, wrapper, kMerVec);
+                std::vector<kmer_t>().swap(kMerVec);
+            }
+        } else if (options.hash_free) {
+            kMerVec = ReadKMersSorted(kmer_type, paths, options.k, options.complements, options.threads);
+            sorted = true;
+        } else if (!options.tmp_dir.empty()) {
+            /* Deduplicate the k-mers on disk so that only the result is kept in memory. */
+            ReadKMersExternal(wrapper, kmer_type, paths, options.k, options.complements, options.tmp_dir, options.threads, [&](auto *bucket) {
+                for (auto i = kh_begin(bucket); i != kh_end(bucket); ++i) {
+                    if (!kh_exist(bucket, i)) continue;
+                    int ret;
+                    if (toVec) kMerVec.push_back(kh_key(bucket, i));
+                    else if (toSwiss) swissWrapper.kh_put_to_set(swissKMers.get(), kh_key(bucket, i), &ret);
+                    else wrapper.kh_put_to_set(kMers, kh_key(bucket, i), &ret);
+                }
+            });
+        } else if (toSwiss) {
+            auto swissShards = readShards(swissWrapper);
+            /* Grow the first shard instead of presizing a new set, so that most of the shards are already freed when it grows. */
+            swissKMers.reset(swissShards[0]);
+            for (size_t shard = 1; shard < swissShards.size(); ++shard) {
+                kmer_t kMer;
+                for (size_t lastIndex = 0; nextKMer(swissShards[shard], kMer, lastIndex); ++lastIndex) {
+                    int ret;
+                    swissWrapper.kh_put_to_set(swissKMers.get(), kMer, &ret);
+                }
+                swissWrapper.kh_destroy_set(swissShards[shard]);
+            }
+        } else {
+            /* The compact set is filled while reading, so that it never coexists with the shards.
+               It is sized by the estimated number of k-mers, which takes an extra pass over the input even without --presize;
+               if they are underestimated, the rest goes to its overflow table. */
+            size_t expectedKMers = options.compact_set && options.min_count <= 1 && !options.bloom_memory ? EstimateDistinctKMers(kmer_type, paths, options.k, options.complements) : 0;
+            if (expectedKMers) {
+                compactKMers = std::make_unique<CompactKMerSet<kmer_t, kh_wrapper_t>>(wrapper, expectedKMers, options.k);
+                ReadKMersInto(*compactKMers, kmer_type, paths, options.k, options.complements, options.threads);
+            } else {
+                auto kMerShards = readShards(wrapper);
+                if (options.algorithm == "global") {
+                    kMerVec = kMersToVec(kMerShards, kmer_type);
+                    for (auto shard : kMerShards) wrapper.kh_destroy_set(shard);
+                } else if (options.compact_set) {
+                    size_t count = 0;
+                    for (auto shard : kMerShards) count += kh_size(shard);
+                    compactKMers = std::make_unique<CompactKMerSet<kmer_t, kh_wrapper_t>>(wrapper, count, options.k);
+                    for (auto shard : kMerShards) {
+                        for (auto i = kh_begin(shard); i != kh_end(shard); ++i) {
+                            if (kh_exist(shard, i)) compactKMers->Insert(kh_key(shard, i));
+                        }
+                        wrapper.kh_destroy_set(shard);
+                    }
+                } else {
+                    wrapper.kh_destroy_set(kMers);
+                    kMers = MergeShards(kMerShards, wrapper);
+                }
+            }
+        }
+        if (kMerVec.empty() && !kh_size(kMers) && !kh_size(swissKMers) && !(compactKMers && compactKMers->Size())) {
+            wrapper.kh_destroy_set(kMers);
+            if (paths.size() == 1) std::cerr << "Path '" << path << "' contains no k-mers." << std::endl;
+            else std::cerr << "Input files contain no k-mers." << std::endl;
             return Help();
         }
-        d_max = std::min(k - 1, d_max);
-        if (!lower_bound) WriteName(k, *of);
-        if (algorithm == "global") {
-            auto kMerVec = kMersToVec(kMers, kmer_type);
+        if (options.save) {
+            wrapper.kh_destroy_set(kMers);
+            WriteKMerSet(kMerVec, options.k, options.complements, *options.of);
+            return 0;
+        }
+        int d_max = std::min(options.k - 1, options.d_max);
+        if (!options.lower_bound) WriteName(options.k, *options.of);
+        if (options.algorithm == "global") {
             wrapper.kh_destroy_set(kMers);
             /* Turn off the memory optimizations if optimize_memory is set to false. */
-            if(optimize_memory) PartialPreSort(kMerVec, k);
-            else MEMORY_REDUCTION_FACTOR = 1;
-            if (lower_bound) std::cout << LowerBoundLength(wrapper, kMerVec, k, complements);
-            else Global(wrapper, kMerVec, *of, k, complements);
+            if (!options.optimize_memory) MEMORY_REDUCTION_FACTOR = 1;
+            /* The k-mers from a k-mer set file or from the hash-free reading are already sorted, so only the presort is skipped. */
+            bool preSort = options.optimize_memory && !sorted;
+            /* Process the resumed k-mers in the same batches as the interrupted run. */
+            if (options.resume) MEMORY_REDUCTION_FACTOR = checkpoint->MemoryReductionFactor();
+            auto run = [&](auto &kMerArray) {
+                if (checkpoint && !options.resume) checkpoint->SaveKMers(kMerArray, options.k, options.complements, options.lower_bound, MEMORY_REDUCTION_FACTOR, maxMemory);
+                if (options.lower_bound && options.merge_join) std::cout << LowerBoundLengthMergeJoin(kMerArray, options.k, options.complements);
+                else if (options.lower_bound && options.swiss_table) std::cout << LowerBoundLength(swiss_dict_t<kmer_t>(), kMerArray, options.k, options.complements, options.threads, maxMemory, checkpoint.get());
+                else if (options.lower_bound) std::cout << LowerBoundLength(wrapper, kMerArray, options.k, options.complements, options.threads, maxMemory, checkpoint.get());
+                else if (options.merge_join) GlobalMergeJoin(kMerArray, *options.of, options.k, options.complements);
+                else if (options.swiss_table) Global(swiss_dict_t<kmer_t>(), kMerArray, *options.of, options.k, options.complements, options.threads, maxMemory, checkpoint.get());
+                else Global(wrapper, kMerArray, *options.of, options.k, options.complements, options.threads, maxMemory, checkpoint.get());
+            };
+            /* Store only ceil(2k / 8) bytes per k-mer if it is less than the size of kmer_t. */
+            if (PackedKMerArray<kmer_t>::SavesMemory(options.k)) {
+                auto packed = preSort ? PartialPreSortPacked(kMerVec, options.k) : PackedKMerArray<kmer_t>(kMerVec, options.k);
+                run(packed);
+            } else {
+                if (preSort) PartialPreSort(kMerVec, options.k);
+                run(kMerVec);
+            }
+        }
+        else if (options.compact_set) {
+            wrapper.kh_destroy_set(kMers);
+            if (!compactKMers) {
+                compactKMers = std::make_unique<CompactKMerSet<kmer_t, kh_wrapper_t>>(wrapper, kMerVec.size(), options.k);
+                for (auto &&kMer : kMerVec) compactKMers->Insert(kMer);
+                std::vector<kmer_t>().swap(kMerVec);
+            }
+            Local(compactKMers.get(), wrapper, kmer_type, *options.of, options.k, d_max, options.complements);
+        }
+        else if (options.swiss_table) {
+            wrapper.kh_destroy_set(kMers);
+            Local(swissKMers.get(), swissWrapper, kmer_type, *options.of, options.k, d_max, options.complements);
         }
-        else Local(kMers, wrapper, kmer_type, *of, k, d_max, complements);
+        else Local(kMers, wrapper, kmer_type, *options.of, options.k, d_max, options.complements);
     } else {
         auto data = ReadFasta(path);
         if (data.empty()) {
             std::cerr << "Path '" << path << "' not to a fasta file." << std::endl;
             return Help();
         }
-        d_max = std::min(k - 1, d_max);
+        int d_max = std::min(options.k - 1, options.d_max);
 
-        auto kMers = ConstructKMers(data, k, complements);
-        WriteName(k, *of);
-        if (algorithm == "globalAC") {
-            GlobalAC(kMers, *of, complements);
+        auto kMers = ConstructKMers(data, options.k, options.complements);
+        WriteName(options.k, *options.of);
+        if (options.algorithm == "globalAC") {
+            GlobalAC(kMers, *options.of, options.complements);
         }
-        else if (algorithm == "localAC") {
-            LocalAC(kMers, *of, k, d_max, complements);
+        else if (options.algorithm == "localAC") {
+            LocalAC(kMers, *options.of, options.k, d_max, options.complements);
         }
         else {
-            std::cerr << "Algorithm '" << algorithm << "' not supported." << std::endl;
+            std::cerr << "Algorithm '" << options.algorithm << "' not supported." << std::endl;
             return Help();
         }
     }
-    *of << std::endl;
+    *options.of << std::endl;
     return 0;
 }
 
+/// Read the paths from the file of files, one per line.
+/// Return no paths if the file cannot be read.
+std::vector<std::string> ReadFileOfFiles(const std::string &listPath) {
+    std::ifstream list(listPath);
+    std::vector<std::string> paths;
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) paths.push_back(line);
+    }
+    return paths;
+}
+
 int main(int argc, char **argv) {
-    std::string path;
-    int k = 0;
-    int d_max = 5;
+    KmerCamelOptions options;
     std::ofstream output;
-    std::ostream *of = &std::cout;
-    bool masks = false;
-    std::string algorithm = "global";
     if (argc > 1 && std::string(argv[1]) == "optimize") {
-        masks = true;
+        options.masks = true;
+        argv++;
+        argc--;
+        options.algorithm = "ones";
+    }
+    if (argc > 1 && std::string(argv[1]) == "save") {
+        options.save = true;
         argv++;
         argc--;
-        algorithm = "ones";
     }
-    bool complements = false;
-    bool optimize_memory = true;
     bool d_set = false;
-    bool lower_bound = false;
+    bool max_memory_set = false;
     int opt;
     try {
-        while ((opt = getopt(argc, argv, "p:k:d:a:o:hcvml"))  != -1) {
+        while ((opt = getopt_long(argc, argv, "p:k:d:a:o:t:T:hcvml", LONG_OPTIONS, nullptr))  != -1) {
             switch(opt) {
                 case  'p':
-                    if (!path.empty()) {
-                        std::cerr << "Error: parameter p set twice." << std::endl;
-                        return Help();
+                    if (optarg[0] == '@') {
+                        auto listed = ReadFileOfFiles(optarg + 1);
+                        if (listed.empty()) {
+                            std::cerr << "File of files '" << optarg + 1 << "' is empty or cannot be read." << std::endl;
+                            return Help();
+                        }
+                        options.paths.insert(options.paths.end(), listed.begin(), listed.end());
+                    } else {
+                        options.paths.push_back(optarg);
                     }
-                    path = optarg;
                     break;
                 case 'o':
                     output.open(optarg);
-                    of = &output;
+                    options.of = &output;
                     break;
                 case  'k':
-                    k = std::stoi(optarg);
+                    options.k = std::stoi(optarg);
                     break;
                 case  'd':
                     d_set = true;
-                    d_max = std::stoi(optarg);
+                    options.d_max = std::stoi(optarg);
                     break;
                 case  'a':
-                    algorithm = optarg;
+                    options.algorithm = optarg;
                     // Backwards compatability.
-                    if (algorithm == "greedy") algorithm = "global";
-                    if (algorithm == "greedyAC") algorithm = "globalAC";
-                    if (algorithm == "pseudosimplitigs") algorithm = "local";
-                    if (algorithm == "pseudosimplitigsAC") algorithm = "localAC";
+                    if (options.algorithm == "greedy") options.algorithm = "global";
+                    if (options.algorithm == "greedyAC") options.algorithm = "globalAC";
+                    if (options.algorithm == "pseudosimplitigs") options.algorithm = "local";
+                    if (options.algorithm == "pseudosimplitigsAC") options.algorithm = "localAC";
                     break;
                 case  'c':
-                    complements = true;
+                    options.complements = true;
                     break;
                 case 'm':
-                    optimize_memory = false;
+                    options.optimize_memory = false;
                     break;
                 case 'l':
-                    lower_bound = true;
+                    options.lower_bound = true;
+                    break;
+                case 't':
+                    options.threads = std::stoi(optarg);
+                    break;
+                case 'T':
+                    options.tmp_dir = optarg;
+                    break;
+                case MIN_COUNT_OPTION:
+                    options.min_count = std::stoi(optarg);
+                    break;
+                case BLOOM_MEMORY_OPTION:
+                    options.bloom_memory = std::stoi(optarg);
+                    break;
+                case HASH_FREE_OPTION:
+                    options.hash_free = true;
+                    break;
+                case COMPACT_SET_OPTION:
+                    options.compact_set = true;
+                    break;
+                case SWISS_TABLE_OPTION:
+                    options.swiss_table = true;
+                    break;
+                case PRESIZE_OPTION:
+                    options.presize = true;
+                    break;
+                case MERGE_JOIN_OPTION:
+                    options.merge_join = true;
+                    break;
+                case MAX_MEMORY_OPTION:
+                    options.max_memory = std::stod(optarg);
+                    max_memory_set = true;
+                    break;
+                case CHECKPOINT_OPTION:
+                    options.checkpoint_dir = optarg;
+                    break;
+                case RESUME_OPTION:
+                    options.resume = true;
                     break;
                 case 'v':
                     Version();
@@ -182,40 +475,137 @@ int main(int argc, char **argv) {
     } catch (std::invalid_argument&) {
         return Help();
     }
-    if (path.empty()) {
+    if (options.paths.empty() && !options.resume) {
         std::cerr << "Required parameter p not set." << std::endl;
         return Help();
     }
-    if (k == 0) {
+    bool kMerSetFile = false;
+    for (auto &&path : options.paths) kMerSetFile = kMerSetFile || IsKMerSetFile(path);
+    if (options.k == 0) {
         std::cerr << "Required parameter k not set." << std::endl;
         return Help();
-    } else if (k < 0) {
+    } else if (options.k < 0) {
         std::cerr << "k must be positive." << std::endl;
         return Help();
-    } else if (d_max < 0) {
+    } else if (options.d_max < 0) {
         std::cerr << "d must be non-negative." << std::endl;
         return Help();
-    } else if (k > MAX_K && (algorithm == "local" || algorithm == "global")) {
-        std::cerr << "k > " << MAX_K << " not supported for the algorithm '" + algorithm + "'. Use the  AC version of the algorithm instead." << std::endl;
+    } else if (options.k > MAX_K && (options.algorithm == "local" || options.algorithm == "global")) {
+        std::cerr << "k > " << MAX_K << " not supported for the algorithm '" + options.algorithm + "'. Use the  AC version of the algorithm instead." << std::endl;
         return Help();
-    } else if (d_set && (algorithm == "globalAC" || algorithm == "global" || algorithm == "streaming")) {
-        std::cerr << "Unsupported argument d for algorithm '" + algorithm + "'." << std::endl;
+    } else if (d_set && (options.algorithm == "globalAC" || options.algorithm == "global" || options.algorithm == "streaming")) {
+        std::cerr << "Unsupported argument d for algorithm '" + options.algorithm + "'." << std::endl;
         return Help();
-    } else if (!optimize_memory && algorithm != "global") {
+    } else if (!options.optimize_memory && options.algorithm != "global") {
         std::cerr << "Memory optimization turn-off only supported for hash table global." << std::endl;
         return Help();
-    } else if (masks && (d_set || !optimize_memory)) {
+    } else if (options.masks && (d_set || !options.optimize_memory)) {
         std::cerr << "Not supported flags for optimize." << std::endl;
         return Help();
-    } else if (lower_bound && algorithm != "global") {
+    } else if (options.lower_bound && options.algorithm != "global") {
         std::cerr << "Lower bound computation supported only for hash table global." << std::endl;
         return Help();
+    } else if (options.threads < 1) {
+        std::cerr << "t must be positive." << std::endl;
+        return Help();
+    } else if (options.threads > 1 && (options.masks ? options.algorithm != "ones" && options.algorithm != "zeros" : options.algorithm != "global" && options.algorithm != "local")) {
+        std::cerr << "Multiple threads supported only for hash table global and local and for optimization of ones and zeros." << std::endl;
+        return Help();
+    } else if (options.save && (d_set || !options.optimize_memory || options.lower_bound || options.algorithm != "global")) {
+        std::cerr << "Not supported flags for save." << std::endl;
+        return Help();
+    } else if (kMerSetFile && (options.masks || (options.algorithm != "global" && options.algorithm != "local"))) {
+        std::cerr << "K-mer set files supported only for hash table global and local." << std::endl;
+        return Help();
+    } else if (options.paths.size() > 1 && (options.masks || (options.algorithm != "global" && options.algorithm != "local"))) {
+        std::cerr << "Multiple input files supported only for hash table global and local." << std::endl;
+        return Help();
+    } else if (options.paths.size() > 1 && kMerSetFile) {
+        std::cerr << "K-mer set files cannot be combined with other input files." << std::endl;
+        return Help();
+    } else if (options.min_count < 1 || options.min_count > UINT8_MAX) {
+        std::cerr << "min-count must be between 1 and " << UINT8_MAX << "." << std::endl;
+        return Help();
+    } else if (options.min_count > 1 && (options.masks || kMerSetFile || (options.algorithm != "global" && options.algorithm != "local"))) {
+        std::cerr << "Abundance filtering supported only for hash table global and local on fasta or fastq files." << std::endl;
+        return Help();
+    } else if (options.min_count > 1 && (options.threads > 1 || !options.tmp_dir.empty())) {
+        std::cerr << "Abundance filtering cannot be combined with t or T." << std::endl;
+        return Help();
+    } else if (options.bloom_memory < 0) {
+        std::cerr << "bloom-memory must be positive." << std::endl;
+        return Help();
+    } else if (options.bloom_memory && (options.masks || kMerSetFile || (options.algorithm != "global" && options.algorithm != "local"))) {
+        std::cerr << "Bloom filtering supported only for hash table global and local on fasta or fastq files." << std::endl;
+        return Help();
+    } else if (options.bloom_memory && (options.threads > 1 || !options.tmp_dir.empty() || options.min_count > 1)) {
+        std::cerr << "Bloom filtering cannot be combined with t, T or min-count." << std::endl;
+        return Help();
+    } else if (options.compact_set && (options.masks || options.save || options.lower_bound || options.algorithm != "local")) {
+        std::cerr << "Compact set supported only for hash table local." << std::endl;
+        return Help();
+    } else if (options.swiss_table && (options.masks || options.save || options.compact_set || (options.algorithm != "global" && options.algorithm != "local"))) {
+        std::cerr << "Swiss tables supported only for hash table global and local without compact-set." << std::endl;
+        return Help();
+    } else if (options.hash_free && (options.masks || kMerSetFile || (options.algorithm != "global" && !options.compact_set))) {
+        std::cerr << "Hash-free reading supported only for hash table global and local with compact-set on fasta files." << std::endl;
+        return Help();
+    } else if (options.hash_free && (!options.tmp_dir.empty() || options.min_count > 1 || options.bloom_memory)) {
+        std::cerr << "Hash-free reading cannot be combined with T, min-count or bloom-memory." << std::endl;
+        return Help();
+    } else if (!options.tmp_dir.empty() && (options.masks || (options.algorithm != "global" && options.algorithm != "local"))) {
+        std::cerr << "Deduplication on disk supported only for hash table global and local." << std::endl;
+        return Help();
+    } else if (options.presize && (options.masks || kMerSetFile || (options.algorithm != "global" && options.algorithm != "local"))) {
+        std::cerr << "Presizing supported only for hash table global and local on fasta or fastq files." << std::endl;
+        return Help();
+    } else if (options.presize && (options.hash_free || !options.tmp_dir.empty() || options.min_count > 1 || options.bloom_memory)) {
+        std::cerr << "Presizing cannot be combined with hash-free, T, min-count or bloom-memory." << std::endl;
+        return Help();
+    } else if (options.merge_join && (options.masks || options.save || options.algorithm != "global")) {
+        std::cerr << "Merge-join supported only for hash table global." << std::endl;
+        return Help();
+    } else if (options.merge_join && options.swiss_table) {
+        std::cerr << "Merge-join cannot be combined with swiss-table." << std::endl;
+        return Help();
+    } else if (options.merge_join && options.threads > 1) {
+        std::cerr << "Merge-join runs on a single thread and cannot be combined with t." << std::endl;
+        return Help();
+    } else if (max_memory_set && options.max_memory <= 0) {
+        std::cerr << "max-memory must be positive." << std::endl;
+        return Help();
+    } else if (options.max_memory && (options.masks || options.save || options.algorithm != "global")) {
+        std::cerr << "Memory limit supported only for hash table global." << std::endl;
+        return Help();
+    } else if (options.max_memory && (!options.optimize_memory || options.merge_join)) {
+        std::cerr << "Memory limit cannot be combined with m or merge-join." << std::endl;
+        return Help();
+    } else if (!options.checkpoint_dir.empty() && (options.masks || options.save || options.algorithm != "global")) {
+        std::cerr << "Checkpoints supported only for hash table global." << std::endl;
+        return Help();
+    } else if (!options.checkpoint_dir.empty() && options.merge_join) {
+        std::cerr << "Checkpoints cannot be combined with merge-join." << std::endl;
+        return Help();
+    } else if (options.resume && options.checkpoint_dir.empty()) {
+        std::cerr << "Resuming requires checkpoint." << std::endl;
+        return Help();
     }
-    if (k < 32) {
-        return kmercamel(kmer_dict64_t(), kmer64_t(0), path, k, d_max, of, complements, masks, algorithm, optimize_memory, lower_bound);
-    } else if (k < 64) {
-        return kmercamel(kmer_dict128_t(), kmer128_t(0), path, k, d_max, of, complements, masks, algorithm, optimize_memory, lower_bound);
+    // Use the narrowest k-mers which fit, as k-mers may fill the whole integer.
+    if (options.k <= 16) {
+        return kmercamel(kmer_dict32_t(), kmer32_t(0), options);
+    } else if (options.k <= 32) {
+        return kmercamel(kmer_dict64_t(), kmer64_t(0), options);
+    } else if (options.k <= 64) {
+        return kmercamel(kmer_dict128_t(), kmer128_t(0), options);
+    } else if (options.k <= 128) {
+        return kmercamel(kmer_dict256_t(), kmer256_t(0), options);
+    } else if (options.k <= 160) {
+        return kmercamel(kmer_dict320_t(), kmer320_t(0), options);
+    } else if (options.k <= 192) {
+        return kmercamel(kmer_dict384_t(), kmer384_t(0), options);
+    } else if (options.k <= 224) {
+        return kmercamel(kmer_dict448_t(), kmer448_t(0), options);
     } else {
-        return kmercamel(kmer_dict256_t(), kmer256_t(0), path, k, d_max, of, complements, masks, algorithm, optimize_memory, lower_bound);
+        return kmercamel(kmer_dict512_t(), kmer512_t(0), options);
     }
 }
@@ -7,6 +7,7 @@
 #include "parser.h"
 #include "khash_utils.h"
 #include "kmers.h"
+#include "encoding.h"
 
 /// Print a warning to stderr if the mask after optimization violates the mask convention
 /// (i.e., if there are more than k-1 last characters OFF).
@@ -47,18 +48,25 @@ void OptimizeOnes(kseq_t* masked_superstring, std::ostream &of, kh_S_t *kMers, k
                   [[maybe_unused]] kmer_t _, int k,
                   bool complements, bool minimize) {
     kmer_t currentKMer = 0, reverseComplement = 0;
-    kmer_t mask = ((kmer_t(1)) << (2 * k)) - 1;
+    kmer_t mask = KMerMask<kmer_t>(k);
     kmer_t shift = 2 * (k - 1);
     ReprintSequenceHeader(masked_superstring, of);
-    uint8_t ms_validation = 0;
-    for (size_t i = 0; i < masked_superstring->seq.l; ++i) {
-        auto data = nucleotideToInt[(uint8_t) masked_superstring->seq.s[i]];
-        ms_validation |= data;
-        currentKMer = ((currentKMer << 2) | data) & mask;
-        reverseComplement = (reverseComplement >> 2) | ((kmer_t(3 ^ data)) << shift);
-        if (i >= (size_t)k - 1) {
-            kmer_t canonical = ((!complements) || currentKMer < reverseComplement) ? currentKMer : reverseComplement;
-            auto kmer_pointer = wrapper.kh_get_from_set(kMers, canonical);
+    uint64_t invalid = 0, lowercase;
+    uint8_t codes[ENCODING_BLOCK_SIZE];
+    kmer_t canonicals[ENCODING_BLOCK_SIZE];
+    for (size_t blockStart = 0; blockStart < masked_superstring->seq.l; blockStart += ENCODING_BLOCK_SIZE) {
+        size_t blockLength = std::min(ENCODING_BLOCK_SIZE, masked_superstring->seq.l - blockStart);
+        invalid |= EncodeNucleotides(masked_superstring->seq.s + blockStart, blockLength, codes, lowercase);
+        // Compute the k-mers of the whole block and prefetch their buckets before looking them up.
+        for (size_t j = 0; j < blockLength; ++j) {
+            currentKMer = ((currentKMer << 2) | codes[j]) & mask;
+            reverseComplement = (reverseComplement >> 2) | ((kmer_t(3 ^ codes[j])) << shift);
+            canonicals[j] = ((!complements) || currentKMer < reverseComplement) ? currentKMer : reverseComplement;
+            if (blockStart + j >= (size_t)k - 1) wrapper.kh_prefetch_set(kMers, canonicals[j]);
+        }
+        for (size_t j = 0, i = blockStart; j < blockLength; ++j, ++i) {
+            if (i < (size_t)k - 1) continue;
+            auto kmer_pointer = wrapper.kh_get_from_set(kMers, canonicals[j]);
             bool contained = kmer_pointer != kh_end(kMers);
             of << Masked(masked_superstring->seq.s[i - k + 1], contained);
             // If minimizing, erase the k-mer once set.
@@ -77,7 +85,52 @@ void OptimizeOnes(kseq_t* masked_superstring, std::ostream &of, kh_S_t *kMers, k
     }
     of << std::endl;
     // Check that characters were only ACGTacgt.
-    if (ms_validation >= 4) {
+    if (invalid) {
+        throw std::invalid_argument("Masked superstring contains invalid characters.");
+    }
+}
+
+/// Same as OptimizeOnes, but on the concurrent k-mer set with the given number of threads.
+/// When maximizing, the ranges of the superstring are masked in parallel. When minimizing, each k-mer is set
+/// at its first occurrence, which depends on the preceding ranges, so the mask is computed by a single thread.
+template <typename kmer_t>
+void OptimizeOnesParallel(kseq_t* masked_superstring, std::ostream &of, ConcurrentKMerSet<kmer_t> &kMers, int k,
+                          bool complements, bool minimize, int threads) {
+    ReprintSequenceHeader(masked_superstring, of);
+    size_t length = masked_superstring->seq.l;
+    const char *sequence = masked_superstring->seq.s;
+    std::string masked(length, 0);
+    std::atomic<bool> invalid(false);
+    if (minimize) threads = 1;
+    RunInParallel(threads, [&](int t) {
+        size_t begin = length * t / threads, end = std::min(length * (t + 1) / threads + k - 1, length);
+        kmer_t currentKMer = 0, reverseComplement = 0;
+        kmer_t mask = KMerMask<kmer_t>(k);
+        int shift = 2 * (k - 1);
+        uint64_t lowercase;
+        uint8_t codes[ENCODING_BLOCK_SIZE];
+        for (size_t i = begin; i < end; ++i) {
+            if ((i - begin) % ENCODING_BLOCK_SIZE == 0) {
+                if (EncodeNucleotides(sequence + i, std::min(ENCODING_BLOCK_SIZE, end - i), codes, lowercase)) invalid = true;
+            }
+            auto data = codes[(i - begin) % ENCODING_BLOCK_SIZE];
+            currentKMer = ((currentKMer << 2) | data) & mask;
+            reverseComplement = (reverseComplement >> 2) | ((kmer_t(3 ^ data)) << shift);
+            if (i >= begin + k - 1) {
+                kmer_t canonical = ((!complements) || currentKMer < reverseComplement) ? currentKMer : reverseComplement;
+                // If minimizing, erase the k-mer once set.
+                bool contained = minimize ? kMers.Erase(canonical) : kMers.Contains(canonical);
+                masked[i - k + 1] = Masked(sequence[i - k + 1], contained);
+            }
+        }
+    });
+    // The remaining k-1 characters.
+    for (size_t i = length - std::min(length, size_t(k - 1)); i < length; ++i) masked[i] = Masked(sequence[i], false);
+    // Print a warning if the mask convention is violated.
+    if (length >= size_t(k) && !isupper(masked[length - k])) PrintMaskConventionWarning();
+    of << masked << std::endl;
+    // Check that characters were only ACGTacgt.
+    if (invalid) {
         throw std::invalid_argument("Masked superstring contains invalid characters.");
     }
 }
@@ -92,15 +145,19 @@ std::pair<size_t, size_t> ReadWriteIntervals(kh_P_t *intervals, kh_S_t *kMers, k
                              const bool* setIntervals = nullptr) {
     bool reading = setIntervals == nullptr;
     kmer_t currentKMer = 0, reverseComplement = 0;
-    kmer_t mask = ((kmer_t(1)) << (2 * k)) - 1;
+    kmer_t mask = KMerMask<kmer_t>(k);
     kmer_t shift = 2 * (k - 1);
     size_t currentInterval = 0;
     size_t occurrences = 0;
     bool interval_used = false;
-    uint8_t ms_validation = 0;
+    uint64_t invalid = 0, lowercase;
+    uint8_t codes[ENCODING_BLOCK_SIZE];
     for (size_t i = 0; i < masked_superstring->seq.l; ++i) {
-        auto data = nucleotideToInt[(uint8_t) masked_superstring->seq.s[i]];
-        ms_validation |= data;
+        if (i % ENCODING_BLOCK_SIZE == 0) {
+            invalid |= EncodeNucleotides(masked_superstring->seq.s + i,
+                                         std::min(ENCODING_BLOCK_SIZE, masked_superstring->seq.l - i), codes, lowercase);
+        }
+        auto data = codes[i % ENCODING_BLOCK_SIZE];
         currentKMer = ((currentKMer << 2) | data) & mask;
         reverseComplement = (reverseComplement >> 2) | ((kmer_t(3 ^ data)) << shift);
         if (i >= (size_t)k - 1) {
@@ -132,7 +189,7 @@ std::pair<size_t, size_t> ReadWriteIntervals(kh_P_t *intervals, kh_S_t *kMers, k
             of << Masked(masked_superstring->seq.s[i], false);
         }
     }
-    if (ms_validation >= 4) {
+    if (invalid) {
         throw std::invalid_argument("Masked superstring contains invalid characters.");
     }
     return {occurrences, currentInterval + interval_used};
@@ -186,7 +243,10 @@ std::pair<std::vector<int>, std::vector<int>> HeuristicPreSolve(std::vector<std:
 template <typename kmer_t, typename kh_S_t, typename kh_wrapper_t>
 void OptimizeRuns(kh_wrapper_t wrapper, kmer_t _, kseq_t* masked_superstring, kh_S_t *kMers, std::ostream &of, int k, bool complements, bool approximate) {
     auto *intervals = wrapper.kh_init_map();
+    // Each k-mer of the set gets one entry, so the map is sized up front to avoid rehashing.
+    wrapper.kh_resize_map(intervals, kh_size(kMers) * 100 / 77 + 1);
     std::vector<std::list<size_t>> intervalsForKMer;
+    intervalsForKMer.reserve(kh_size(kMers));
     auto [size, rows] = ReadWriteIntervals(intervals, kMers, wrapper, _, intervalsForKMer, masked_superstring, k, complements, of, nullptr);
     int mappedSize, newIntervals; size_t totalIntervals;
     auto [mapping, intervalMapping] = HeuristicPreSolve(intervalsForKMer, rows, mappedSize, totalIntervals, newIntervals);
@@ -242,8 +302,20 @@ void OptimizeRuns(kh_wrapper_t wrapper, kmer_t _, kseq_t* masked_superstring, kh
 }
 
 template <typename kmer_t, typename kh_wrapper_t>
-int Optimize(kh_wrapper_t wrapper, kmer_t _, std::string &algorithm, std::string path, std::ostream &of,  int k, bool complements) {
+int Optimize(kh_wrapper_t wrapper, kmer_t _, const std::string &algorithm, std::string path, std::ostream &of,  int k, bool complements,
+             int threads = 1) {
     kseq_t* masked_superstring = ReadMaskedSuperstring(path);
+    if (threads > 1 && (algorithm == "ones" || algorithm == "zeros")) {
+        // Each represented k-mer starts at an upper case letter, so there are no more k-mers than such letters.
+        size_t upperCase = std::count_if(masked_superstring->seq.s, masked_superstring->seq.s + masked_superstring->seq.l,
+                                         [](char c) { return isupper(c); });
+        ConcurrentKMerSet<kmer_t> kMers(upperCase);
+        AddKMersParallel(kMers, masked_superstring->seq.l, masked_superstring->seq.s, k, complements, true, threads);
+        OptimizeOnesParallel(masked_superstring, of, kMers, k, complements, algorithm == "zeros", threads);
+        AssertEOF(masked_superstring, "Expecting only a single FASTA record -- the masked superstring.");
+        CloseMaskedSuperstring(masked_superstring);
+        return 0;
+    }
     auto *kMers = wrapper.kh_init_set();
     AddKMers(kMers, wrapper, _, masked_superstring->seq.l, masked_superstring->seq.s, k, complements, true);
 
@@ -257,10 +329,10 @@ int Optimize(kh_wrapper_t wrapper, kmer_t _, std::string &algorithm, std::string
         OptimizeRuns(wrapper, _,masked_superstring, kMers, of, k, complements, true);
     } else {
         std::cerr << "Algorithm '" + algorithm + "' not recognized." << std::endl;
-        kseq_destroy(masked_superstring);
+        CloseMaskedSuperstring(masked_superstring);
         return 1;
     }
     AssertEOF(masked_superstring, "Expecting only a single FASTA record -- the masked superstring.");
-    kseq_destroy(masked_superstring);
+    CloseMaskedSuperstring(masked_superstring);
     return 0;
 }
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#include "kmers.h"
+
+/// Array of k-mers which stores each k-mer in ceil(2k / 8) bytes instead of the whole kmer_t.
+/// The k-mers are stored in little endian one after another, so a k-mer is loaded by a single unaligned load
+/// of the whole kmer_t, which also reads the following bytes, and by masking out the bits of the next k-mers.
+/// The array is padded so that such a load never reads past its end.
+/// The k-mers are only read by operator[] and written by Set, as there are no references to the packed k-mers.
+template <typename kmer_t>
+class PackedKMerArray {
+public:
+    typedef kmer_t value_type;
+
+    PackedKMerArray() = default;
+
+    /// Create an array of the given number of zero k-mers.
+    PackedKMerArray(size_t size, int k) : count(size), bytes(BytesPerKMer(k)), mask(KMerMask<kmer_t>(k)),
+                                          data(size * bytes + sizeof(kmer_t), 0) {}
+
+    /// Pack the k-mers and free the vector.
+    PackedKMerArray(std::vector<kmer_t> &kMers, int k) : PackedKMerArray(kMers.size(), k) {
+        for (size_t i = 0; i < count; ++i) Set(i, kMers[i]);
+        std::vector<kmer_t>().swap(kMers);
+    }
+
+    kmer_t operator[](size_t index) const {
+        kmer_t kMer;
+        memcpy(&kMer, data.data() + index * bytes, sizeof(kmer_t));
+        return kMer & mask;
+    }
+
+    void Set(size_t index, kmer_t kMer) {
+        memcpy(data.data() + index * bytes, &kMer, bytes);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return !count;
+    }
+
+    /// Return the number of bytes taken by the array.
+    size_t MemoryUsage() const {
+        return data.size();
+    }
+
+    /// Return the number of bytes used by each k-mer.
+    static size_t BytesPerKMer(int k) {
+        return (2 * size_t(k) + 7) / 8;
+    }
+
+    /// Determine whether the packed k-mers take less memory than kmer_t.
+    static bool SavesMemory(int k) {
+        return BytesPerKMer(k) < sizeof(kmer_t);
+    }
+
+private:
+    size_t count = 0;
+    size_t bytes = sizeof(kmer_t);
+    kmer_t mask = kmer_t(-1);
+    std::vector<uint8_t> data;
+};
+
+/// Array of k-mer indices which stores each index in 4 bytes if all the indices fit into 32 bits and in 5 bytes otherwise.
+/// The largest value of the used width stands for size_t(-1), so it can still be used as the missing index.
+/// As in PackedKMerArray, an index is loaded by a single unaligned load of 8 bytes and a mask.
+/// Indices are written through the proxy returned by operator[], so the array can be used as a vector of indices.
+class PackedIndexArray {
+public:
+    /// Proxy of an index in the array, which converts to the index and can be assigned to.
+    class Reference {
+    public:
+        Reference(PackedIndexArray &array, size_t index) : array(array), index(index) {}
+
+        operator size_t() const {
+            return array.Get(index);
+        }
+
+        Reference &operator=(size_t value) {
+            array.Set(index, value);
+            return *this;
+        }
+
+        Reference &operator=(const Reference &other) {
+            return *this = size_t(other);
+        }
+
+    private:
+        PackedIndexArray &array;
+        size_t index;
+    };
+
+    PackedIndexArray() = default;
+
+    /// Create an array of the given size for indices up to maxIndex filled with the given value.
+    PackedIndexArray(size_t size, size_t maxIndex, size_t value = -1) : count(size), bytes(BytesPerIndex(maxIndex)),
+                                                                       mask((uint64_t(1) << (8 * bytes)) - 1),
+                                                                       data(size * bytes + sizeof(uint64_t), 0xFF) {
+        if (value != size_t(-1)) for (size_t i = 0; i < count; ++i) Set(i, value);
+    }
+
+    /// Create an array of the given indices.
+    PackedIndexArray(std::initializer_list<size_t> indices) : PackedIndexArray(indices.size(), indices.size()) {
+        size_t i = 0;
+        for (size_t index : indices) Set(i++, index);
+    }
+
+    size_t operator[](size_t index) const {
+        return Get(index);
+    }
+
+    Reference operator[](size_t index) {
+        return Reference(*this, index);
+    }
+
+    size_t Get(size_t index) const {
+        uint64_t value;
+        memcpy(&value, data.data() + index * bytes, sizeof(uint64_t));
+        value &= mask;
+        return value == mask ? size_t(-1) : size_t(value);
+    }
+
+    /// Set the index, writing only its own bytes, so that different indices can be set by different threads.
+    void Set(size_t index, size_t value) {
+        if (bytes == sizeof(uint32_t)) {
+            uint32_t narrow = uint32_t(value);
+            memcpy(data.data() + index * bytes, &narrow, sizeof(uint32_t));
+        } else {
+            uint64_t wide = value;
+            memcpy(data.data() + index * bytes, &wide, 5);
+        }
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return !count;
+    }
+
+    /// Return the number of bytes taken by the array.
+    size_t MemoryUsage() const {
+        return data.size();
+    }
+
+    /// Return the number of bytes used by each index if the indices are at most maxIndex.
+    static size_t BytesPerIndex(size_t maxIndex) {
+        return maxIndex < UINT32_MAX ? sizeof(uint32_t) : 5;
+    }
+
+    friend bool operator==(const PackedIndexArray &a, const PackedIndexArray &b) {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (a[i] != b[i]) return false;
+        }
+        return true;
+    }
+
+    friend bool operator!=(const PackedIndexArray &a, const PackedIndexArray &b) {
+        return !(a == b);
+    }
+
+private:
+    size_t count = 0;
+    size_t bytes = sizeof(uint32_t);
+    uint64_t mask = UINT32_MAX;
+    std::vector<uint8_t> data;
+};
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <thread>
+#include <vector>
+
+/// Queue with bounded capacity for passing work between threads.
+/// Push blocks while the queue is full and Pop blocks while it is empty and not closed.
+template <typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity) : capacity(capacity) {}
+
+    /// Add the item to the end of the queue.
+    void Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notFull.wait(lock, [&] { return items.size() < capacity; });
+        items.emplace_back(std::move(item));
+        notEmpty.notify_one();
+    }
+
+    /// Remove the first item from the queue.
+    /// Return false if the queue is closed and there are no more items.
+    bool Pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        notEmpty.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+
+    /// Signal that no more items will be pushed.
+    void Close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        notEmpty.notify_all();
+    }
+
+private:
+    size_t capacity;
+    bool closed = false;
+    std::deque<T> items;
+    std::mutex mutex;
+    std::condition_variable notEmpty, notFull;
+};
+
+/// Run the given function with the thread index on the given number of threads and wait for all of them.
+template <typename F>
+void RunInParallel(int threads, F &&function) {
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) workers.emplace_back(function, t);
+    function(0);
+    for (auto &&worker : workers) worker.join();
+}
@@ -6,47 +6,163 @@
 
 #include <zlib.h>
 #include <stdio.h>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bgzf.h"
+#include "async_reader.h"
+
+/// Input file read through zlib on a separate thread or, for BGZF files, decompressed by several threads.
+struct InputFile {
+    AsyncReader *async = nullptr;
+    BgzfReader *bgzf = nullptr;
+};
+
+/// Read up to length decompressed bytes from the input file.
+int ReadInput(InputFile *fp, void *buffer, int length) {
+    if (fp->bgzf) return fp->bgzf->Read(buffer, length);
+    return fp->async->Read(buffer, length);
+}
+
 #include "kseq.h"
-KSEQ_INIT(gzFile, gzread)
+KSEQ_INIT(InputFile*, ReadInput)
 
 #include "kmers.h"
 #include "khash_utils.h"
+#include "parallel.h"
+#include "encoding.h"
+#include "bloom.h"
+#include "radix_sort.h"
+#include "concurrent_set.h"
+#include "hyperloglog.h"
 
 
-/// Fill the k-mer dictionary with k-mers from the given sequence.
-/// If complements is true, always add the canonical k-mers.
-/// If case_sensitive is true, add the k-mer only if it starts with an upper case letter.
-template <typename kmer_t, typename kh_S_t, typename kh_wrapper_t>
-void AddKMers(kh_S_t *kMers, kh_wrapper_t wrapper, [[maybe_unused]] kmer_t _, size_t sequence_length,
-              const char* sequence, int64_t k, bool complements, bool case_sensitive = false) {
-    int64_t currentLength = 0;
+/// Encoding of the last nucleotides of a sequence, which can be carried over between its consecutive parts.
+template <typename kmer_t>
+struct RollingKMer {
     kmer_t currentKMer = 0, reverseComplement = 0;
     kmer_t cases = 0;
-    kmer_t mask = (((kmer_t) 1) <<  (2 * k) ) - 1;
+    int64_t currentLength = 0;
+};
+
+/// Call the callback on each k-mer of the given sequence, continuing from the given rolling state.
+/// If complements is true, pass the canonical k-mers.
+/// If case_sensitive is true, pass the k-mer only if it starts with an upper case letter.
+template <typename kmer_t, typename F>
+void ForEachKMer(RollingKMer<kmer_t> &state, size_t sequence_length, const char* sequence, int64_t k, bool complements,
+                 bool case_sensitive, F &&callback) {
+    int64_t currentLength = state.currentLength;
+    kmer_t currentKMer = state.currentKMer, reverseComplement = state.reverseComplement;
+    kmer_t cases = state.cases;
+    kmer_t mask = KMerMask<kmer_t>(k);
     kmer_t shift = 2 * (k - 1);
-    for (size_t i = 0; i < sequence_length; ++i) {
-        auto data = nucleotideToInt[(uint8_t)sequence[i]];
-        if (data >= 4) {
-            // Restart if "N"-like nucleotide.
-            currentKMer = reverseComplement = 0;
-            currentLength = 0;
-            continue;
+    uint8_t codes[ENCODING_BLOCK_SIZE];
+    for (size_t blockStart = 0; blockStart < sequence_length; blockStart += ENCODING_BLOCK_SIZE) {
+        size_t blockLength = std::min(ENCODING_BLOCK_SIZE, sequence_length - blockStart);
+        uint64_t lowercase;
+        uint64_t invalid = EncodeNucleotides(sequence + blockStart, blockLength, codes, lowercase);
+        for (size_t i = 0; i < blockLength; ++i) {
+            if ((invalid >> i) & 1) {
+                // Restart if "N"-like nucleotide.
+                currentKMer = reverseComplement = 0;
+                currentLength = 0;
+                continue;
+            }
+            auto data = codes[i];
+            currentKMer = ((currentKMer << 2) | data) & mask;
+            reverseComplement = (reverseComplement >> 2) | ((kmer_t(3 ^ data)) << shift);
+            // K-mer is present if it is upper case or case-insensitive.
+            if (case_sensitive) cases = (cases | kmer_t(!((lowercase >> i) & 1))) << 1;
+            if ((++currentLength >= k) && (!case_sensitive || (cases & (kmer_t(1) << k)))) {
+                kmer_t canonical = ((!complements) || currentKMer < reverseComplement) ? currentKMer : reverseComplement;
+                callback(canonical);
+            }
         }
-        currentKMer = ((currentKMer << 2) | data) & mask;
-        reverseComplement = (reverseComplement >> 2) | ((kmer_t(3 ^ data)) << shift);
-        // K-mer is present if it is upper case or case-insensitive.
-        cases = (cases | (!case_sensitive || sequence[i] <= 'Z')) << 1;
-        if ((++currentLength >= k) && (cases & (kmer_t(1) << k))) {
-            // Add the canonical k-mer to the dictionary.
-            kmer_t canonical = ((!complements) || currentKMer < reverseComplement) ? currentKMer : reverseComplement;
-            int ret;
-            wrapper.kh_put_to_set(kMers, canonical, &ret);
+    }
+    state = {currentKMer, reverseComplement, cases, currentLength};
+}
+
+/// Call the callback on each k-mer starting in the byte range [begin, end) of an uncompressed fasta file in memory.
+/// The range has to start at the beginning of a line.
+/// K-mers starting in the range are finished even if they straddle newlines or the end of the range.
+template <typename kmer_t, typename F>
+void ForEachKMerInRange([[maybe_unused]] kmer_t _, const char *data, size_t size, size_t begin, size_t end, int64_t k,
+                        bool complements, bool case_sensitive, F &&callback) {
+    RollingKMer<kmer_t> state;
+    // The number of sequence characters past the end of the range which still need to be read.
+    int64_t remaining = k - 1;
+    size_t position = begin;
+    while (position < size && (position < end || remaining > 0)) {
+        const char *lineEnd = (const char*)memchr(data + position, '\n', size - position);
+        size_t next = lineEnd ? lineEnd - data : size;
+        if (data[position] == '>') {
+            // A new record ends all the k-mers from the range.
+            if (position >= end) break;
+            state = RollingKMer<kmer_t>();
+        } else {
+            size_t lineLength = next - position;
+            if (lineLength && data[next - 1] == '\r') --lineLength;
+            if (position + lineLength > end) {
+                // Read only the characters needed to finish the k-mers starting in the range.
+                size_t inRange = end > position ? end - position : 0;
+                lineLength = std::min(lineLength, inRange + remaining);
+                remaining -= lineLength - inRange;
+            }
+            ForEachKMer(state, lineLength, data + position, k, complements, case_sensitive, callback);
         }
+        position = next + 1;
     }
 }
 
+/// Fill the k-mer dictionary with k-mers from the given sequence.
+/// If complements is true, always add the canonical k-mers.
+/// If case_sensitive is true, add the k-mer only if it starts with an upper case letter.
+template <typename kmer_t, typename kh_S_t, typename kh_wrapper_t>
+void AddKMers(kh_S_t *kMers, kh_wrapper_t wrapper, [[maybe_unused]] kmer_t _, size_t sequence_length,
+              const char* sequence, int64_t k, bool complements, bool case_sensitive = false) {
+    RollingKMer<kmer_t> state;
+    ForEachKMer(state, sequence_length, sequence, k, complements, case_sensitive, [&](kmer_t canonical) {
+        int ret;
+        wrapper.kh_put_to_set(kMers, canonical, &ret);
+    });
+}
+
+/// Fill the concurrent k-mer set with k-mers from the given sequence using the given number of threads.
+/// Each thread adds the k-mers starting in its range of the sequence.
+/// If case_sensitive is true, add the k-mer only if it starts with an upper case letter.
+template <typename kmer_t>
+void AddKMersParallel(ConcurrentKMerSet<kmer_t> &kMers, size_t sequence_length, const char* sequence, int64_t k,
+                      bool complements, bool case_sensitive, int threads) {
+    RunInParallel(threads, [&](int t) {
+        size_t begin = sequence_length * t / threads, end = sequence_length * (t + 1) / threads;
+        RollingKMer<kmer_t> state;
+        ForEachKMer(state, std::min(end + k - 1, sequence_length) - begin, sequence + begin, k, complements, case_sensitive,
+                    [&](kmer_t canonical) { kMers.Insert(canonical); });
+    });
+}
+
+/// Count the occurrences of the k-mers from the given sequence; the counts saturate at UINT8_MAX.
+/// If complements is true, count the canonical k-mers.
+template <typename kmer_t, typename kh_C_t, typename kh_wrapper_t>
+void CountKMers(kh_C_t *counts, kh_wrapper_t wrapper, [[maybe_unused]] kmer_t _, size_t sequence_length,
+                const char* sequence, int64_t k, bool complements) {
+    RollingKMer<kmer_t> state;
+    ForEachKMer(state, sequence_length, sequence, k, complements, false, [&](kmer_t canonical) {
+        int ret;
+        khint_t key = wrapper.kh_put_to_counter(counts, canonical, &ret);
+        if (ret) kh_val(counts, key) = 0;
+        if (kh_val(counts, key) != UINT8_MAX) ++kh_val(counts, key);
+    });
+}
+
 /// Return a file/stdin for reading.
-gzFile OpenFile(std::string &path) {
+/// The file is read ahead on a separate thread while the caller processes the already read data.
+/// If more threads are provided and the file is BGZF-compressed, its blocks are decompressed in parallel.
+InputFile *OpenFile(std::string &path, int threads = 1) {
     FILE *in_stream;
     if(path=="-"){
         in_stream = stdin;
@@ -57,17 +173,128 @@ gzFile OpenFile(std::string &path) {
             throw std::invalid_argument("couldn't open file " + path);
         }
     }
-    gzFile fp = gzdopen(fileno(in_stream), "r");
+    auto *fp = new InputFile();
+    if (threads > 1 && IsBgzf(fileno(in_stream))) fp->bgzf = new BgzfReader(fileno(in_stream), threads);
+    else fp->async = new AsyncReader(gzdopen(fileno(in_stream), "r"));
     return fp;
 }
 
+/// Close the file opened by OpenFile.
+void CloseFile(InputFile *fp) {
+    if (fp->bgzf) delete fp->bgzf;
+    else delete fp->async;
+    delete fp;
+}
+
+
+/// Uncompressed file mapped into memory.
+struct MappedFile {
+    const char *data = nullptr;
+    size_t size = 0;
+};
+
+/// Unmap the file mapped by MapFile.
+void UnmapFile(MappedFile &file) {
+    if (file.data) munmap((void*)file.data, file.size);
+    file = MappedFile();
+}
+
+/// Map the file into memory if it is a nonempty regular file.
+/// Otherwise, return a MappedFile without data.
+MappedFile MapFile(const std::string &path) {
+    MappedFile file;
+    if (path == "-") return file;
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return file;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0) {
+        void *data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            file.data = (const char*)data;
+            file.size = info.st_size;
+            madvise(data, info.st_size, MADV_WILLNEED);
+        }
+    }
+    close(fd);
+    return file;
+}
+
+/// Map the file into memory if it is an uncompressed fasta file.
+/// Otherwise, return a MappedFile without data.
+MappedFile MapFastaFile(const std::string &path) {
+    MappedFile file = MapFile(path);
+    if (file.data && file.data[0] != '>') UnmapFile(file);
+    return file;
+}
+
+/// The number of bases of a file which is not mapped into memory sampled to estimate its number of distinct k-mers.
+constexpr size_t ESTIMATION_SAMPLE_SIZE = size_t(1) << 26;
+
+/// Estimate the number of distinct k-mers in the fasta or fastq files by HyperLogLog.
+/// Return 0 if the input cannot be read twice, i.e. it is the standard input.
+/// Uncompressed fasta files are mapped into memory and read whole. Of the other files, the sequences up to
+/// ESTIMATION_SAMPLE_SIZE bases are sampled and the estimate is extrapolated to the whole compressed file
+/// by the growth of the estimate between the first half and the whole sample. Thus the estimate of redundant inputs,
+/// such as reads with high coverage, does not grow linearly with the file size.
+/// If complements is true, count the canonical k-mers.
+template <typename kmer_t>
+size_t EstimateDistinctKMers(kmer_t _, std::vector<std::string> &paths, int k, bool complements) {
+    HyperLogLog whole;
+    double extrapolated = 0;
+    auto add = [](HyperLogLog &sketch) {
+        return [&sketch](kmer_t kMer) { sketch.Add(MixHash(FoldKMer(kMer))); };
+    };
+    for (auto &&path : paths) {
+        struct stat info;
+        if (path == "-" || stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return 0;
+        MappedFile file = MapFastaFile(path);
+        if (file.data) {
+            ForEachKMerInRange(_, file.data, file.size, 0, file.size, k, complements, false, add(whole));
+            UnmapFile(file);
+            continue;
+        }
+        HyperLogLog sample, half;
+        size_t bases = 0;
+        long halfOffset = 0, offset = 0;
+        InputFile *fp = OpenFile(path);
+        kseq_t *seq = kseq_init(fp);
+        while (bases < ESTIMATION_SAMPLE_SIZE && kseq_read(seq) >= 0) {
+            RollingKMer<kmer_t> state;
+            ForEachKMer(state, seq->seq.l, seq->seq.s, k, complements, false, add(sample));
+            bases += seq->seq.l;
+            offset = fp->async->CompressedOffset();
+            if (!halfOffset && bases >= ESTIMATION_SAMPLE_SIZE / 2) {
+                half = sample;
+                halfOffset = offset;
+            }
+        }
+        bool sampled = bases >= ESTIMATION_SAMPLE_SIZE && kseq_read(seq) >= 0;
+        kseq_destroy(seq);
+        CloseFile(fp);
+        if (!sampled) {
+            whole.Merge(sample);
+            continue;
+        }
+        // Fit the number of distinct k-mers in the first x bytes by c * x^growth with 0 <= growth <= 1.
+        double growth = 1;
+        if (halfOffset > 0 && offset > halfOffset) {
+            growth = std::log(sample.Estimate() / half.Estimate()) / std::log(double(offset) / halfOffset);
+            growth = std::max(0.0, std::min(1.0, growth));
+        }
+        extrapolated += sample.Estimate() * std::pow(double(info.st_size) / std::max(offset, 1L), growth);
+    }
+    return size_t(whole.Estimate() + extrapolated);
+}
 
 /// Load a dictionary of k-mers from a fasta file.
 /// If complements is true, add the canonical k-mers.
+/// If threads is more than one, BGZF-compressed files are decompressed in parallel.
+/// If expectedKMers is provided, the dictionary is resized up front so that it holds them without rehashing.
 template <typename kmer_t, typename kh_S_t, typename kh_wrapper_t>
 void ReadKMers(kh_S_t *kMers, kh_wrapper_t wrapper, kmer_t _, std::string &path, int k, bool complements,
-               bool case_sensitive = false) {
-    gzFile fp = OpenFile(path);
+               bool case_sensitive = false, int threads = 1, size_t expectedKMers = 0) {
+    if (expectedKMers) wrapper.kh_resize_set(kMers, expectedKMers * 100 / 77 + 1);
+    InputFile *fp = OpenFile(path, threads);
     kseq_t *seq = kseq_init(fp);
 
     while (kseq_read(seq) >= 0) {
@@ -75,17 +302,307 @@ void ReadKMers(kh_S_t *kMers, kh_wrapper_t wrapper, kmer_t _, std::string &path,
     }
 
     kseq_destroy(seq);
-    gzclose(fp);
+    CloseFile(fp);
+}
+
+/// The number of bases in one chunk of a sequence processed by a single worker.
+constexpr size_t INGESTION_CHUNK_SIZE = 1 << 20;
+/// The number of k-mer shards per thread; more shards mean less contention on the shard locks.
+constexpr int SHARDS_PER_THREAD = 4;
+/// The number of k-mers a worker buffers for a shard before locking it.
+constexpr size_t SHARD_BUFFER_SIZE = 1 << 12;
+/// The bytes a worker uses for the buffers of all the shards; with many shards, each buffer gets a smaller share.
+constexpr size_t SHARD_BUFFERS_MEMORY = 1 << 18;
+/// The number of k-mers in one chunk appended to by a worker in the hash-free ingestion.
+constexpr size_t SORTING_CHUNK_SIZE = 1 << 20;
+
+/// Call callback(thread, kMer) on each k-mer of the fasta file, where thread is the index of the calling worker.
+/// Uncompressed fasta files are mapped into memory and split into byte ranges at line boundaries.
+/// Otherwise, the sequences are split into overlapping chunks which are distributed to the workers.
+template <typename kmer_t, typename F>
+void ForEachKMerParallel(kmer_t _, std::string &path, int k, bool complements, int threads, bool case_sensitive,
+                         F &&callback) {
+    MappedFile file = MapFastaFile(path);
+    if (file.data) {
+        // Split the file into more ranges than threads so that the work is balanced.
+        size_t rangesCount = size_t(threads) * SHARDS_PER_THREAD;
+        std::vector<size_t> boundaries {0};
+        for (size_t i = 1; i < rangesCount; ++i) {
+            const char *lineEnd = (const char*)memchr(file.data + file.size * i / rangesCount, '\n',
+                                                      file.size - file.size * i / rangesCount);
+            boundaries.push_back(std::max(boundaries.back(), lineEnd ? size_t(lineEnd - file.data) + 1 : file.size));
+        }
+        boundaries.push_back(file.size);
+        std::atomic<size_t> nextRange(0);
+        RunInParallel(threads, [&](int t) {
+            for (size_t range = nextRange++; range < rangesCount; range = nextRange++) {
+                ForEachKMerInRange(_, file.data, file.size, boundaries[range], boundaries[range + 1], k, complements,
+                                   case_sensitive, [&](kmer_t kMer) { callback(t, kMer); });
+            }
+        });
+        UnmapFile(file);
+        return;
+    }
+
+    BlockingQueue<std::string> chunks(2 * threads);
+    auto worker = [&](int t) {
+        std::string chunk;
+        while (chunks.Pop(chunk)) {
+            RollingKMer<kmer_t> state;
+            ForEachKMer(state, chunk.size(), chunk.data(), k, complements, case_sensitive,
+                        [&](kmer_t kMer) { callback(t, kMer); });
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) workers.emplace_back(worker, t);
+
+    InputFile *fp = OpenFile(path, threads);
+    kseq_t *seq = kseq_init(fp);
+    while (kseq_read(seq) >= 0) {
+        // Consecutive chunks overlap by k-1 characters so that no k-mer is lost on the boundary.
+        for (size_t begin = 0; begin + k <= seq->seq.l + 1; begin += INGESTION_CHUNK_SIZE) {
+            size_t end = std::min(seq->seq.l, begin + INGESTION_CHUNK_SIZE + k - 1);
+            chunks.Push(std::string(seq->seq.s + begin, end - begin));
+        }
+    }
+    kseq_destroy(seq);
+    CloseFile(fp);
+    chunks.Close();
+    for (auto &&w : workers) w.join();
+}
+
+/// Return the number of k-mers a worker buffers for each of the given number of shards.
+/// The buffers of a worker fit into SHARD_BUFFERS_MEMORY, so that their memory grows linearly with the threads
+/// even though the number of shards does too.
+template <typename kmer_t>
+size_t ShardBufferSize(size_t shardsCount) {
+    return std::max(size_t(1), std::min(SHARD_BUFFER_SIZE, SHARD_BUFFERS_MEMORY / sizeof(kmer_t) / shardsCount));
+}
+
+/// Load the k-mers from a fasta file into disjoint hash-partitioned sets using the given number of threads.
+/// With a single thread, this is equivalent to ReadKMers with one shard.
+/// If expectedKMers is provided, the shards are resized up front so that they hold them without rehashing.
+template <typename kmer_t, typename kh_wrapper_t>
+auto ReadKMersSharded(kh_wrapper_t wrapper, kmer_t _, std::string &path, int k, bool complements, int threads,
+                      bool case_sensitive = false, size_t expectedKMers = 0) {
+    typedef decltype(wrapper.kh_init_set()) kh_S_ptr_t;
+    if (threads <= 1) {
+        auto *kMers = wrapper.kh_init_set();
+        ReadKMers(kMers, wrapper, _, path, k, complements, case_sensitive, 1, expectedKMers);
+        return std::vector<kh_S_ptr_t>{kMers};
+    }
+    size_t shardsCount = size_t(threads) * SHARDS_PER_THREAD;
+    std::vector<kh_S_ptr_t> shards(shardsCount);
+    for (auto &&shard : shards) {
+        shard = wrapper.kh_init_set();
+        // The k-mers are distributed uniformly among the shards by their hash.
+        if (expectedKMers) wrapper.kh_resize_set(shard, expectedKMers / shardsCount * 100 / 77 + 1);
+    }
+    std::vector<std::mutex> locks(shardsCount);
+    // buffers[t][s] contains the k-mers from the worker t to be inserted to the shard s.
+    std::vector<std::vector<std::vector<kmer_t>>> buffers(threads, std::vector<std::vector<kmer_t>>(shardsCount));
+    size_t bufferSize = ShardBufferSize<kmer_t>(shardsCount);
+
+    auto flush = [&](std::vector<kmer_t> &buffer, size_t shard) {
+        std::lock_guard<std::mutex> lock(locks[shard]);
+        for (auto &&kMer : buffer) {
+            int ret;
+            wrapper.kh_put_to_set(shards[shard], kMer, &ret);
+        }
+        buffer.clear();
+    };
+    ForEachKMerParallel(_, path, k, complements, threads, case_sensitive, [&](int t, kmer_t canonical) {
+        size_t shard = KMerShard(canonical, shardsCount);
+        buffers[t][shard].push_back(canonical);
+        if (buffers[t][shard].size() >= bufferSize) flush(buffers[t][shard], shard);
+    });
+    for (auto &&threadBuffers : buffers) {
+        for (size_t shard = 0; shard < shardsCount; ++shard) flush(threadBuffers[shard], shard);
+    }
+    return shards;
+}
+
+/// Insert the k-mers from the fasta files directly into the given set using the given number of threads.
+/// The set needs only an Insert method and need not be thread-safe, as the workers insert their buffers under a lock.
+/// Thus only the parsing runs in parallel and the inserts are serialized.
+template <typename kmer_t, typename set_t>
+void ReadKMersInto(set_t &kMers, kmer_t _, std::vector<std::string> &paths, int k, bool complements, int threads) {
+    std::mutex lock;
+    // buffers[t] contains the k-mers from the worker t to be inserted to the set.
+    std::vector<std::vector<kmer_t>> buffers(threads);
+    auto flush = [&](std::vector<kmer_t> &buffer) {
+        std::lock_guard<std::mutex> guard(lock);
+        for (auto &&kMer : buffer) kMers.Insert(kMer);
+        buffer.clear();
+    };
+    for (auto &&path : paths) {
+        ForEachKMerParallel(_, path, k, complements, threads, false, [&](int t, kmer_t canonical) {
+            buffers[t].push_back(canonical);
+            if (buffers[t].size() >= SHARD_BUFFER_SIZE) flush(buffers[t]);
+        });
+    }
+    for (auto &&buffer : buffers) flush(buffer);
+}
+
+/// Load the k-mers from the fasta files into a sorted vector without duplicates, without using a hash table.
+/// The workers append the k-mers to their chunks, which are then joined, sorted by the radix sort and deduplicated.
+template <typename kmer_t>
+std::vector<kmer_t> ReadKMersSorted(kmer_t _, std::vector<std::string> &paths, int k, bool complements, int threads) {
+    // chunks[t] contains the k-mers appended by the worker t; the chunks are never reallocated.
+    std::vector<std::vector<std::vector<kmer_t>>> chunks(threads);
+    for (auto &&path : paths) {
+        ForEachKMerParallel(_, path, k, complements, threads, false, [&](int t, kmer_t canonical) {
+            if (chunks[t].empty() || chunks[t].back().size() == SORTING_CHUNK_SIZE) {
+                chunks[t].emplace_back();
+                chunks[t].back().reserve(SORTING_CHUNK_SIZE);
+            }
+            chunks[t].back().push_back(canonical);
+        });
+    }
+    size_t size = 0;
+    for (auto &&threadChunks : chunks) {
+        for (auto &&chunk : threadChunks) size += chunk.size();
+    }
+    std::vector<kmer_t> kMers;
+    kMers.reserve(size);
+    for (auto &&threadChunks : chunks) {
+        for (auto &&chunk : threadChunks) {
+            kMers.insert(kMers.end(), chunk.begin(), chunk.end());
+            std::vector<kmer_t>().swap(chunk);
+        }
+    }
+    ParallelRadixSort(kMers, k, threads);
+    kMers.erase(std::unique(kMers.begin(), kMers.end()), kMers.end());
+    kMers.shrink_to_fit();
+    return kMers;
+}
+
+/// Load the k-mers from several fasta files into disjoint hash-partitioned sets using the given number of threads.
+/// Each file is read by a single worker into its thread-local set. The sets are then split by the shards
+/// and the parts of each shard are united in parallel.
+/// If expectedKMers is provided, each thread-local set is resized up front to hold its share of the k-mers,
+/// assuming that the files are of similar sizes.
+template <typename kmer_t, typename kh_wrapper_t>
+auto ReadKMersFromFiles(kh_wrapper_t wrapper, kmer_t _, std::vector<std::string> &paths, int k, bool complements,
+                        int threads, bool case_sensitive = false, size_t expectedKMers = 0) {
+    typedef decltype(wrapper.kh_init_set()) kh_S_ptr_t;
+    threads = std::max(1, std::min(threads, (int)paths.size()));
+    size_t shardsCount = size_t(threads) * SHARDS_PER_THREAD;
+    // parts[t][s] contains the k-mers read by the thread t which belong to the shard s.
+    std::vector<std::vector<std::vector<kmer_t>>> parts(threads);
+    std::atomic<size_t> nextFile(0);
+    RunInParallel(threads, [&](int t) {
+        auto *kMers = wrapper.kh_init_set();
+        if (expectedKMers) wrapper.kh_resize_set(kMers, expectedKMers / threads * 100 / 77 + 1);
+        for (size_t file = nextFile++; file < paths.size(); file = nextFile++) {
+            ReadKMers(kMers, wrapper, _, paths[file], k, complements, case_sensitive);
+        }
+        parts[t].resize(shardsCount);
+        kmer_t kMer;
+        for (size_t lastIndex = 0; nextKMer(kMers, kMer, lastIndex); ++lastIndex) {
+            parts[t][KMerShard(kMer, shardsCount)].push_back(kMer);
+        }
+        wrapper.kh_destroy_set(kMers);
+    });
+
+    std::vector<kh_S_ptr_t> shards(shardsCount);
+    std::atomic<size_t> nextShard(0);
+    RunInParallel(threads, [&](int) {
+        for (size_t shard = nextShard++; shard < shardsCount; shard = nextShard++) {
+            shards[shard] = wrapper.kh_init_set();
+            size_t largestPart = 0;
+            for (auto &&part : parts) largestPart = std::max(largestPart, part[shard].size());
+            wrapper.kh_resize_set(shards[shard], largestPart * 100 / 77 + 1);
+            for (auto &&part : parts) {
+                for (auto &&kMer : part[shard]) {
+                    int ret;
+                    wrapper.kh_put_to_set(shards[shard], kMer, &ret);
+                }
+                std::vector<kmer_t>().swap(part[shard]);
+            }
+        }
+    });
+    return shards;
+}
+
+/// Load the solid k-mers, i.e. those occurring at least minCount times, from the fasta or fastq files.
+/// The occurrences are counted in a table with one-byte saturating counters, so minCount can be at most UINT8_MAX.
+/// The occurrences are counted by the khash wrapper and the solid k-mers are stored in a set of setWrapper.
+template <typename kmer_t, typename kh_wrapper_t, typename set_wrapper_t>
+auto ReadSolidKMers(kh_wrapper_t wrapper, set_wrapper_t setWrapper, kmer_t _, std::vector<std::string> &paths, int k,
+                    bool complements, int minCount) {
+    auto *counts = wrapper.kh_init_counter();
+    for (auto &&path : paths) {
+        InputFile *fp = OpenFile(path);
+        kseq_t *seq = kseq_init(fp);
+        while (kseq_read(seq) >= 0) {
+            CountKMers(counts, wrapper, _, seq->seq.l, seq->seq.s, k, complements);
+        }
+        kseq_destroy(seq);
+        CloseFile(fp);
+    }
+    size_t solidCount = 0;
+    for (auto i = kh_begin(counts); i != kh_end(counts); ++i) {
+        if (kh_exist(counts, i) && kh_val(counts, i) >= minCount) ++solidCount;
+    }
+    auto *kMers = setWrapper.kh_init_set();
+    setWrapper.kh_resize_set(kMers, solidCount * 100 / 77 + 1);
+    for (auto i = kh_begin(counts); i != kh_end(counts); ++i) {
+        if (!kh_exist(counts, i) || kh_val(counts, i) < minCount) continue;
+        int ret;
+        setWrapper.kh_put_to_set(kMers, kh_key(counts, i), &ret);
+    }
+    wrapper.kh_destroy_counter(counts);
+    return kMers;
+}
+
+/// Load the solid k-mers into a set of the same wrapper which counts them.
+template <typename kmer_t, typename kh_wrapper_t>
+auto ReadSolidKMers(kh_wrapper_t wrapper, kmer_t _, std::vector<std::string> &paths, int k, bool complements,
+                    int minCount) {
+    return ReadSolidKMers(wrapper, wrapper, _, paths, k, complements, minCount);
+}
+
+/// Load the k-mers occurring at least twice from the fasta or fastq files.
+/// The first occurrences are absorbed by a Bloom filter of the given size and a k-mer is inserted into the set
+/// only when the filter reports it as seen. Thus, a k-mer occurring once is loaded only on a false positive.
+template <typename kmer_t, typename kh_wrapper_t>
+auto ReadKMersFiltered(kh_wrapper_t wrapper, kmer_t _, std::vector<std::string> &paths, int k, bool complements,
+                       size_t filterBytes) {
+    BlockedBloomFilter filter(filterBytes);
+    auto *kMers = wrapper.kh_init_set();
+    for (auto &&path : paths) {
+        InputFile *fp = OpenFile(path);
+        kseq_t *seq = kseq_init(fp);
+        while (kseq_read(seq) >= 0) {
+            RollingKMer<kmer_t> state;
+            ForEachKMer(state, seq->seq.l, seq->seq.s, k, complements, false, [&](kmer_t canonical) {
+                if (!filter.Insert(MixHash(FoldKMer(canonical)))) return;
+                int ret;
+                wrapper.kh_put_to_set(kMers, canonical, &ret);
+            });
+        }
+        kseq_destroy(seq);
+        CloseFile(fp);
+    }
+    return kMers;
 }
 
 /// Read the masked superstring from the given path and return it wrapped as a kseq_t.
 kseq_t* ReadMaskedSuperstring(std::string &path) {
-    gzFile fp = OpenFile(path);
+    InputFile *fp = OpenFile(path);
     kseq_t *seq = kseq_init(fp);
     kseq_read(seq);
     return seq;
 }
 
+/// Close the masked superstring read by ReadMaskedSuperstring together with its file.
+void CloseMaskedSuperstring(kseq_t *seq) {
+    InputFile *fp = seq->f->f;
+    kseq_destroy(seq);
+    CloseFile(fp);
+}
+
 /// Ensure that the file is at the end.
 void AssertEOF(kseq_t *seq, std::string message) {
     if (kseq_read(seq) >= 0) {
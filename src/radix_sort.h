@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "parallel.h"
+
+/// The number of bits of k-mers sorted by a single pass of the radix sort.
+constexpr int RADIX_BITS = 8;
+/// Ranges up to this size are sorted by std::sort instead of further radix passes.
+constexpr size_t RADIX_SORT_THRESHOLD = 64;
+
+/// Return the digit of the k-mer consisting of bits [shift, shift + bits).
+template <typename kmer_t>
+inline size_t RadixDigit(kmer_t kMer, int shift, int bits) {
+    return (uint64_t)((kMer >> shift) & ((kmer_t(1) << bits) - kmer_t(1)));
+}
+
+/// Move the k-mers in place into the buckets given by their digit.
+/// counts contain the sizes of the buckets and are overwritten by their ends.
+template <typename kmer_t>
+void RadixPermute(kmer_t *begin, std::vector<size_t> &counts, int shift, int bits) {
+    std::vector<size_t> heads(counts.size());
+    size_t position = 0;
+    for (size_t digit = 0; digit < counts.size(); ++digit) {
+        heads[digit] = position;
+        position += counts[digit];
+        counts[digit] = position;
+    }
+    for (size_t digit = 0; digit < counts.size(); ++digit) {
+        // Cycle leader: move the k-mer to its bucket and continue with the k-mer it displaced.
+        while (heads[digit] < counts[digit]) {
+            kmer_t kMer = begin[heads[digit]];
+            size_t kMerDigit = RadixDigit(kMer, shift, bits);
+            while (kMerDigit != digit) {
+                std::swap(kMer, begin[heads[kMerDigit]++]);
+                kMerDigit = RadixDigit(kMer, shift, bits);
+            }
+            begin[heads[digit]++] = kMer;
+        }
+    }
+}
+
+/// Sort the k-mers in place by their lowest shift + bits bits, of which the top bits are sorted first.
+template <typename kmer_t>
+void RadixSortKMers(kmer_t *begin, kmer_t *end, int shift, int bits) {
+    if (size_t(end - begin) <= RADIX_SORT_THRESHOLD) {
+        std::sort(begin, end);
+        return;
+    }
+    std::vector<size_t> counts(size_t(1) << bits, 0);
+    for (kmer_t *kMer = begin; kMer != end; ++kMer) counts[RadixDigit(*kMer, shift, bits)]++;
+    RadixPermute(begin, counts, shift, bits);
+    if (shift == 0) return;
+    int nextBits = std::min(RADIX_BITS, shift);
+    size_t bucketBegin = 0;
+    for (size_t bucketEnd : counts) {
+        RadixSortKMers(begin + bucketBegin, begin + bucketEnd, shift - nextBits, nextBits);
+        bucketBegin = bucketEnd;
+    }
+}
+
+/// Sort the k-mers in place using the MSD radix sort with the given number of threads.
+/// The top digit is counted in parallel and the resulting buckets are then sorted in parallel.
+template <typename kmer_t>
+void ParallelRadixSort(std::vector<kmer_t> &kMers, int k, int threads) {
+    int bits = std::min(RADIX_BITS, 2 * k);
+    int shift = 2 * k - bits;
+    std::vector<std::vector<size_t>> threadCounts(threads, std::vector<size_t>(size_t(1) << bits, 0));
+    RunInParallel(threads, [&](int t) {
+        size_t begin = kMers.size() * t / threads, end = kMers.size() * (t + 1) / threads;
+        for (size_t i = begin; i < end; ++i) threadCounts[t][RadixDigit(kMers[i], shift, bits)]++;
+    });
+    std::vector<size_t> counts(size_t(1) << bits, 0);
+    for (auto &&threadCount : threadCounts) {
+        for (size_t digit = 0; digit < counts.size(); ++digit) counts[digit] += threadCount[digit];
+    }
+    RadixPermute(kMers.data(), counts, shift, bits);
+    if (shift == 0) return;
+    int nextBits = std::min(RADIX_BITS, shift);
+    std::atomic<size_t> nextBucket(0);
+    RunInParallel(threads, [&](int) {
+        for (size_t bucket = nextBucket++; bucket < counts.size(); bucket = nextBucket++) {
+            size_t bucketBegin = bucket ? counts[bucket - 1] : 0;
+            RadixSortKMers(kMers.data() + bucketBegin, kMers.data() + counts[bucket], shift - nextBits, nextBits);
+        }
+    });
+}
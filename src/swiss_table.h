@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "kmers.h"
+#include "khash_utils.h"
+
+/// The number of control bytes probed at once.
+constexpr size_t SWISS_GROUP_SIZE = 16;
+
+/// Hash of the k-mer for the Swiss tables.
+/// Unlike the khash hashes of the wide k-mers, all the bits of the k-mer are mixed into all the bits of the hash.
+inline uint64_t SwissHash(kmer32_t kMer) {
+    return MixHash(kMer);
+}
+
+/// Hash of the k-mer for the Swiss tables.
+inline uint64_t SwissHash(kmer64_t kMer) {
+    return MixHash(kMer);
+}
+
+/// Hash of the k-mer for the Swiss tables.
+inline uint64_t SwissHash(kmer128_t kMer) {
+    return MixHash((uint64_t)kMer ^ MixHash((uint64_t)(kMer >> 64)));
+}
+
+/// Hash of the k-mer for the Swiss tables.
+inline uint64_t SwissHash(kmer256_t kMer) {
+    return MixHash(SwissHash(kMer.lo) + 0x9E3779B97F4A7C15ULL * SwissHash(kMer.hi));
+}
+
+/// Hash of the k-mer for the Swiss tables.
+template <int W>
+inline uint64_t SwissHash(const kmer_words<W> &kMer) {
+    uint64_t hash = 0;
+    for (int i = 0; i < W; ++i) hash = MixHash(hash ^ kMer.words[i]);
+    return hash;
+}
+
+/// Slot of a Swiss table map with the value next to the k-mer so that a lookup touches a single cache line of slots.
+template <typename kmer_t, typename val_t>
+struct SwissSlot {
+    kmer_t key;
+    val_t val;
+};
+
+/// Slot of a Swiss table set.
+template <typename kmer_t>
+struct SwissSlot<kmer_t, void> {
+    kmer_t key;
+};
+
+/// Accessor of the keys of the slots which mimics the khash array.
+template <typename slot_t>
+struct SwissKeys {
+    slot_t *slots = nullptr;
+
+    auto &operator[](khint_t i) const {
+        return slots[i].key;
+    }
+};
+
+/// Accessor of the values of the slots which mimics the khash array.
+template <typename slot_t>
+struct SwissVals {
+    slot_t *slots = nullptr;
+
+    auto &operator[](khint_t i) const {
+        return slots[i].val;
+    }
+};
+
+/// Open-addressing hash table of k-mers in the style of the Swiss tables.
+/// Each slot has a control byte, which is either EMPTY, DELETED, or the 7 lowest bits of the hash of its k-mer.
+/// The control bytes of a group of 16 slots are compared with the hash at once using SSE2,
+/// so a lookup usually examines a single group and only the k-mers whose 7 bits of the hash match.
+/// The groups are probed quadratically and the table grows at the load of 7/8.
+/// The fields are named as in khash so that kh_end, kh_key, kh_val and kh_size work on the table;
+/// kh_exist does not, and the table has to be iterated by IsFull instead. Sets have void values.
+template <typename kmer_t, typename val_t>
+struct SwissTable {
+    typedef SwissSlot<kmer_t, val_t> slot_t;
+
+    khint_t n_buckets = 0, size = 0;
+    /// The number of DELETED slots.
+    khint_t deleted = 0;
+    int8_t *ctrl = nullptr;
+    slot_t *slots = nullptr;
+    SwissKeys<slot_t> keys;
+    SwissVals<slot_t> vals;
+
+    static constexpr int8_t EMPTY = -128;
+    static constexpr int8_t DELETED = -2;
+
+    SwissTable() = default;
+    SwissTable(const SwissTable&) = delete;
+    SwissTable &operator=(const SwissTable&) = delete;
+
+    ~SwissTable() {
+        Free();
+    }
+
+    /// Determine whether the slot contains a k-mer.
+    bool IsFull(khint_t i) const {
+        return ctrl[i] >= 0;
+    }
+
+    /// Return the slot of the k-mer or n_buckets if it is not present.
+    khint_t Get(kmer_t kMer) const {
+        if (!n_buckets) return n_buckets;
+        uint64_t hash = SwissHash(kMer);
+        int8_t h2 = hash & 0x7F;
+        khint_t groupsMask = n_buckets / SWISS_GROUP_SIZE - 1;
+        khint_t group = (hash >> 7) & groupsMask;
+        for (khint_t step = 1; ; group = (group + step++) & groupsMask) {
+            const int8_t *groupCtrl = ctrl + group * SWISS_GROUP_SIZE;
+            for (uint32_t matches = Match(groupCtrl, h2); matches; matches &= matches - 1) {
+                khint_t i = group * SWISS_GROUP_SIZE + __builtin_ctz(matches);
+                if (slots[i].key == kMer) return i;
+            }
+            if (Match(groupCtrl, EMPTY)) return n_buckets;
+        }
+    }
+
+    /// Prefetch the control bytes and the slots of the first group probed for the k-mer.
+    void Prefetch(kmer_t kMer) const {
+        if (!n_buckets) return;
+        khint_t group = (SwissHash(kMer) >> 7) & (n_buckets / SWISS_GROUP_SIZE - 1);
+        __builtin_prefetch(ctrl + group * SWISS_GROUP_SIZE);
+        __builtin_prefetch(slots + group * SWISS_GROUP_SIZE);
+    }
+
+    /// Insert the k-mer and return its slot; ret is set to 1 if it was not present and to 0 otherwise.
+    /// As in khash, the previously returned slots are invalidated if the table grows.
+    khint_t Put(kmer_t kMer, int *ret) {
+        khint_t i = Get(kMer);
+        if (i != n_buckets) {
+            *ret = 0;
+            return i;
+        }
+        if ((size + deleted + 1) * 8 > n_buckets * 7) {
+            // Grow if there are many k-mers, otherwise only remove the DELETED slots.
+            Resize(size * 16 > n_buckets * 7 ? n_buckets * 2 : n_buckets);
+        }
+        *ret = 1;
+        uint64_t hash = SwissHash(kMer);
+        i = FindFree(hash);
+        if (ctrl[i] == DELETED) --deleted;
+        ctrl[i] = hash & 0x7F;
+        slots[i].key = kMer;
+        ++size;
+        return i;
+    }
+
+    /// Remove the k-mer at the given slot.
+    void Del(khint_t i) {
+        const int8_t *groupCtrl = ctrl + i / SWISS_GROUP_SIZE * SWISS_GROUP_SIZE;
+        // Lookups stop at a group with an EMPTY slot, so such a group can get another EMPTY slot.
+        if (Match(groupCtrl, EMPTY)) {
+            ctrl[i] = EMPTY;
+        } else {
+            ctrl[i] = DELETED;
+            ++deleted;
+        }
+        --size;
+    }
+
+    /// Remove all the k-mers, keeping the capacity.
+    void Clear() {
+        if (n_buckets) memset(ctrl, EMPTY, n_buckets);
+        size = deleted = 0;
+    }
+
+    /// Reallocate the table to the given number of slots, rounded up to a power of two,
+    /// unless the k-mers would not fit.
+    void Resize(khint_t buckets) {
+        khint_t newBuckets = SWISS_GROUP_SIZE;
+        while (newBuckets < buckets || newBuckets * 7 < size * 8) newBuckets *= 2;
+        SwissTable old;
+        std::swap(n_buckets, old.n_buckets);
+        std::swap(size, old.size);
+        std::swap(ctrl, old.ctrl);
+        std::swap(slots, old.slots);
+        deleted = 0;
+        n_buckets = newBuckets;
+        ctrl = (int8_t*)malloc(n_buckets);
+        memset(ctrl, EMPTY, n_buckets);
+        slots = (slot_t*)malloc(n_buckets * sizeof(slot_t));
+        keys.slots = vals.slots = slots;
+        for (khint_t j = 0; j < old.n_buckets; ++j) {
+            if (!old.IsFull(j)) continue;
+            uint64_t hash = SwissHash(old.slots[j].key);
+            khint_t i = FindFree(hash);
+            ctrl[i] = hash & 0x7F;
+            slots[i] = old.slots[j];
+            ++size;
+        }
+    }
+
+private:
+    /// Return the bitmask of the slots in the group with the given control byte.
+    static uint32_t Match(const int8_t *groupCtrl, int8_t value) {
+#ifdef __SSE2__
+        __m128i group = _mm_load_si128((const __m128i*)groupCtrl);
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(value)));
+#else
+        uint32_t matches = 0;
+        for (size_t i = 0; i < SWISS_GROUP_SIZE; ++i) matches |= uint32_t(groupCtrl[i] == value) << i;
+        return matches;
+#endif
+    }
+
+    /// Return the bitmask of the EMPTY or DELETED slots in the group, i.e. those with the highest bit set.
+    static uint32_t MatchFree(const int8_t *groupCtrl) {
+#ifdef __SSE2__
+        return _mm_movemask_epi8(_mm_load_si128((const __m128i*)groupCtrl));
+#else
+        uint32_t matches = 0;
+        for (size_t i = 0; i < SWISS_GROUP_SIZE; ++i) matches |= uint32_t(groupCtrl[i] < 0) << i;
+        return matches;
+#endif
+    }
+
+    /// Return the first EMPTY or DELETED slot in the probe sequence of the hash.
+    khint_t FindFree(uint64_t hash) const {
+        khint_t groupsMask = n_buckets / SWISS_GROUP_SIZE - 1;
+        khint_t group = (hash >> 7) & groupsMask;
+        for (khint_t step = 1; ; group = (group + step++) & groupsMask) {
+            uint32_t free = MatchFree(ctrl + group * SWISS_GROUP_SIZE);
+            if (free) return group * SWISS_GROUP_SIZE + __builtin_ctz(free);
+        }
+    }
+
+    void Free() {
+        free(ctrl);
+        free(slots);
+    }
+};
+
+/// Wrapper with the same interface as the khash wrappers which provides Swiss table sets and maps instead.
+/// The control bytes are allocated by malloc, which aligns them to 16 bytes as needed by the group loads.
+template <typename kmer_t>
+struct swiss_dict_t {
+    typedef SwissTable<kmer_t, void> set_t;
+    typedef SwissTable<kmer_t, size_t> map_t;
+
+    inline set_t *kh_init_set() {
+        return new set_t();
+    }
+    inline khint_t kh_get_from_set(set_t *set, kmer_t key) {
+        return set->Get(key);
+    }
+    inline khint_t kh_put_to_set(set_t *set, kmer_t key, int *ret) {
+        return set->Put(key, ret);
+    }
+    inline void kh_del_from_set(set_t *set, khint_t key) {
+        set->Del(key);
+    }
+    inline void kh_destroy_set(set_t *set) {
+        delete set;
+    }
+    inline void kh_resize_set(set_t *set, khint_t size) {
+        set->Resize(size);
+    }
+    inline void kh_prefetch_set(set_t *set, kmer_t key) {
+        set->Prefetch(key);
+    }
+    inline map_t *kh_init_map() {
+        return new map_t();
+    }
+    inline khint_t kh_get_from_map(map_t *map, kmer_t key) {
+        return map->Get(key);
+    }
+    inline khint_t kh_put_to_map(map_t *map, kmer_t key, int *ret) {
+        return map->Put(key, ret);
+    }
+    inline void kh_del_from_map(map_t *map, khint_t key) {
+        map->Del(key);
+    }
+    inline void kh_destroy_map(map_t *map) {
+        delete map;
+    }
+    inline void kh_clear_map(map_t *map) {
+        map->Clear();
+    }
+    inline void kh_resize_map(map_t *map, khint_t size) {
+        map->Resize(size);
+    }
+    inline void kh_prefetch_map(map_t *map, kmer_t key) {
+        map->Prefetch(key);
+    }
+};
+
+/// Find the next k-mer in the k-mer set and update the index. Return false if there are no more k-mers.
+template <typename kmer_t, typename val_t>
+bool nextKMer(SwissTable<kmer_t, val_t> *kMers, kmer_t &kMer, size_t &lastIndex) {
+    for (; lastIndex < kh_end(kMers); ++lastIndex) {
+        if (!kMers->IsFull(lastIndex)) continue;
+        kMer = kh_key(kMers, lastIndex);
+        return true;
+    }
+    return false;
+}
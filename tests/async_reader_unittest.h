@@ -0,0 +1,70 @@
+#pragma once
+#include "../src/async_reader.h"
+#include "../src/parser.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+namespace {
+// Retrieving current path on Windows does not work as on linux
+// therefore the following unittests are linux-specific.
+#ifdef __unix__
+    TEST(AsyncReader, Read) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/test.fa";
+        std::ifstream plain(path);
+        std::stringstream wantResult;
+        wantResult << plain.rdbuf();
+
+        for (std::string suffix : {"", ".gz", ".bgz"}) {
+            for (int bufferSize : {1, 5, 1000}) {
+                AsyncReader reader(gzopen((path + suffix).c_str(), "r"));
+                std::string gotResult;
+                std::vector<char> buffer(bufferSize);
+                int length;
+                while ((length = reader.Read(buffer.data(), bufferSize)) > 0) gotResult.append(buffer.data(), length);
+
+                EXPECT_EQ(0, length);
+                EXPECT_EQ(wantResult.str(), gotResult);
+                EXPECT_EQ(0, reader.Read(buffer.data(), bufferSize));
+            }
+        }
+    }
+
+    TEST(AsyncReader, ReadMoreBuffers) {
+        std::string path = std::filesystem::temp_directory_path() / "kmercamel_test_async.fa";
+        std::string wantResult;
+        for (size_t i = 0; wantResult.size() < ASYNC_BUFFER_SIZE * (ASYNC_BUFFERS_COUNT + 2); ++i) {
+            wantResult += ">" + std::to_string(i) + "\nACGTTGCA" + std::to_string(i * i) + "\n";
+        }
+        std::ofstream(path) << wantResult;
+
+        InputFile *fp = OpenFile(path);
+        EXPECT_NE(nullptr, fp->async);
+        std::string gotResult;
+        std::vector<char> buffer(12345);
+        int length;
+        while ((length = ReadInput(fp, buffer.data(), buffer.size())) > 0) gotResult.append(buffer.data(), length);
+        CloseFile(fp);
+
+        EXPECT_EQ(wantResult, gotResult);
+        std::filesystem::remove(path);
+    }
+
+    TEST(AsyncReader, CloseEarly) {
+        std::string path = std::filesystem::temp_directory_path() / "kmercamel_test_async_early.fa";
+        std::ofstream(path) << std::string(ASYNC_BUFFER_SIZE * (ASYNC_BUFFERS_COUNT + 2), 'A');
+
+        InputFile *fp = OpenFile(path);
+        char buffer[10];
+        EXPECT_EQ(10, ReadInput(fp, buffer, 10));
+        // The reader thread must stop even though not all the buffers were consumed.
+        CloseFile(fp);
+        std::filesystem::remove(path);
+    }
+#endif
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "../src/bgzf.h"
+#include "../src/parser.h"
+
+#include <fcntl.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(Bgzf, BgzfBlockSize) {
+        uint8_t bgzf[] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0, 27, 0};
+        uint8_t gzip[] = {31, 139, 8, 0, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0, 27, 0};
+        uint8_t otherSubfield[] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'X', 'Y', 2, 0, 27, 0};
+
+        EXPECT_EQ(28, BgzfBlockSize(bgzf, sizeof(bgzf)));
+        EXPECT_EQ(0, BgzfBlockSize(bgzf, 12));
+        EXPECT_EQ(0, BgzfBlockSize(gzip, sizeof(gzip)));
+        EXPECT_EQ(0, BgzfBlockSize(otherSubfield, sizeof(otherSubfield)));
+    }
+
+// Retrieving current path on Windows does not work as on linux
+// therefore the following unittests are linux-specific.
+#ifdef __unix__
+    TEST(Bgzf, IsBgzf) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/test.fa";
+        struct TestCase {
+            std::string suffix;
+            bool wantResult;
+        };
+        std::vector<TestCase> tests = {
+                {"", false},
+                {".gz", false},
+                {".bgz", true},
+        };
+
+        for (auto &t : tests) {
+            int fd = open((path + t.suffix).c_str(), O_RDONLY);
+            EXPECT_EQ(t.wantResult, IsBgzf(fd));
+            close(fd);
+        }
+    }
+
+    TEST(Bgzf, Read) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/test.fa";
+        std::ifstream plain(path);
+        std::stringstream wantResult;
+        wantResult << plain.rdbuf();
+
+        for (int threads : {1, 2, 4}) {
+            for (int bufferSize : {1, 5, 1000}) {
+                std::string bgzfPath = path + ".bgz";
+                InputFile *fp = OpenFile(bgzfPath, threads);
+                EXPECT_EQ(threads > 1, fp->bgzf != nullptr);
+                std::string gotResult;
+                std::vector<char> buffer(bufferSize);
+                int length;
+                while ((length = ReadInput(fp, buffer.data(), bufferSize)) > 0) gotResult.append(buffer.data(), length);
+                CloseFile(fp);
+
+                EXPECT_EQ(0, length);
+                EXPECT_EQ(wantResult.str(), gotResult);
+            }
+        }
+    }
+#endif
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include "../src/bloom.h"
+#include "../src/khash_utils.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(Bloom, Insert) {
+        BlockedBloomFilter filter(1 << 10);
+        for (uint64_t i = 0; i < 100; ++i) EXPECT_FALSE(filter.Insert(MixHash(i)));
+        for (uint64_t i = 0; i < 100; ++i) {
+            EXPECT_TRUE(filter.Contains(MixHash(i)));
+            EXPECT_TRUE(filter.Insert(MixHash(i)));
+        }
+    }
+
+    TEST(Bloom, FalsePositiveRate) {
+        BlockedBloomFilter filter(1 << 20);
+        EXPECT_EQ(1 << 20, filter.Size());
+        size_t count = 1 << 17;
+        for (uint64_t i = 0; i < count; ++i) filter.Insert(MixHash(i));
+        size_t falsePositives = 0;
+        for (uint64_t i = count; i < 2 * count; ++i) falsePositives += filter.Contains(MixHash(i));
+        // 64 bits per element with 4 bits per element yield a false positive rate of about 0.05 %.
+        EXPECT_LT(falsePositives, count / 200);
+    }
+
+    TEST(Bloom, MinimalSize) {
+        BlockedBloomFilter filter(0);
+        EXPECT_EQ(64, filter.Size());
+        filter.Insert(0);
+        EXPECT_TRUE(filter.Contains(0));
+    }
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "../src/checkpoint.h"
+#include "../src/global.h"
+#include "../src/lower_bound.h"
+
+#include "kmer_types.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+    /// Return distinct pseudo-random k-mers, with only one k-mer of each complement pair if complements are set.
+    std::vector<kmer_t> CheckpointKMers(size_t count, int k, bool complements) {
+        std::vector<kmer_t> kMers;
+        for (size_t i = 0; i < count; ++i) {
+            kmer_t kMer = kmer_t(MixHash(i * 7 + 1)) & KMerMask<kmer_t>(k);
+            if (!complements || kMer < ReverseComplement(kMer, k)) kMers.push_back(kMer);
+        }
+        std::sort(kMers.begin(), kMers.end());
+        kMers.erase(std::unique(kMers.begin(), kMers.end()), kMers.end());
+        return kMers;
+    }
+
+    TEST(GlobalCheckpoint, SaveAndLoadKMers) {
+        std::string dir = std::filesystem::temp_directory_path() / "kmercamel_test_checkpoint_kmers";
+        int k = 11;
+        auto kMers = CheckpointKMers(500, k, false);
+        // Keep the k-mers out of the sorted order to check that the order is preserved.
+        std::reverse(kMers.begin(), kMers.end());
+        {
+            GlobalCheckpoint checkpoint(dir, false);
+            checkpoint.SaveKMers(kMers, k, false, false, 16, 0);
+        }
+        GlobalCheckpoint checkpoint(dir, true);
+        std::vector<kmer_t> got;
+        EXPECT_FALSE(checkpoint.LoadKMers(got, k + 1, false, false, 0));
+        EXPECT_FALSE(checkpoint.LoadKMers(got, k, true, false, 0));
+        EXPECT_FALSE(checkpoint.LoadKMers(got, k, false, true, 0));
+        EXPECT_FALSE(checkpoint.LoadKMers(got, k, false, false, 1 << 30));
+        ASSERT_TRUE(checkpoint.LoadKMers(got, k, false, false, 0));
+        EXPECT_EQ(kMers, got);
+        EXPECT_EQ(16, checkpoint.MemoryReductionFactor());
+
+        PackedKMerArray<kmer_t> packed(got, k);
+        {
+            GlobalCheckpoint packedCheckpoint(dir, false);
+            packedCheckpoint.SaveKMers(packed, k, false, false, 1, 1 << 30);
+        }
+        EXPECT_FALSE(checkpoint.LoadKMers(got, k, false, false, 0));
+        ASSERT_TRUE(checkpoint.LoadKMers(got, k, false, false, 1 << 30));
+        EXPECT_EQ(kMers, got);
+        EXPECT_EQ(1, checkpoint.MemoryReductionFactor());
+
+        // The k-mers are rejected with an edge log of other k-mers, e.g. from another run in the same directory.
+        for (size_t n : {kMers.size(), kMers.size() + 1}) {
+            {
+                GlobalCheckpoint logCheckpoint(dir, false);
+                logCheckpoint.OpenEdgeLog(n, k, false, false, [](size_t, size_t, int) {});
+            }
+            EXPECT_EQ(n == kMers.size(), checkpoint.LoadKMers(got, k, false, false, 1 << 30));
+        }
+        std::filesystem::remove_all(dir);
+    }
+
+    TEST(GlobalCheckpoint, Resume) {
+        std::string dir = std::filesystem::temp_directory_path() / "kmercamel_test_checkpoint_resume";
+        int k = 9;
+        for (bool complements : {false, true}) {
+            for (bool lowerBound : {false, true}) {
+                auto kMers = CheckpointKMers(3000, k, complements);
+                auto want = OverlapHamiltonianPath(wrapper, kMers, k, complements, lowerBound);
+                {
+                    GlobalCheckpoint checkpoint(dir, false);
+                    auto got = OverlapHamiltonianPath(wrapper, kMers, k, complements, lowerBound, 1, 0, &checkpoint);
+                    EXPECT_EQ(want.first, got.first);
+                    EXPECT_EQ(want.second, got.second);
+                }
+                // Interrupt the run at different points of the log, also in the middle of a record.
+                std::string edgesPath = dir + "/edges.bin";
+                std::string log;
+                {
+                    std::ifstream in(edgesPath, std::ios::binary);
+                    log.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                }
+                for (size_t size : {size_t(0), sizeof(CheckpointHeader), log.size() / 3 + 5, log.size() / 2, log.size()}) {
+                    std::ofstream(edgesPath, std::ios::binary) << log.substr(0, size);
+                    GlobalCheckpoint checkpoint(dir, true);
+                    auto got = OverlapHamiltonianPath(wrapper, kMers, k, complements, lowerBound, 1, 0, &checkpoint);
+                    EXPECT_EQ(want.first, got.first);
+                    EXPECT_EQ(want.second, got.second);
+                }
+                // A log written with the other lowerBound, which LoadKMers rejects, is not replayed.
+                auto other = OverlapHamiltonianPath(wrapper, kMers, k, complements, !lowerBound);
+                GlobalCheckpoint checkpoint(dir, true);
+                auto got = OverlapHamiltonianPath(wrapper, kMers, k, complements, !lowerBound, 1, 0, &checkpoint);
+                EXPECT_EQ(other.first, got.first);
+                EXPECT_EQ(other.second, got.second);
+            }
+        }
+        std::filesystem::remove_all(dir);
+    }
+}
@@ -0,0 +1,131 @@
+#pragma once
+#include "../src/compact_set.h"
+#include "../src/local.h"
+#include "../src/parser.h"
+
+#include "kmer_types.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+namespace {
+    /// Return a pseudorandom k-mer.
+    kmer_t RandomKMer(uint64_t seed, int k) {
+        kmer_t kMer = 0;
+        for (size_t i = 0; i < sizeof(kmer_t) / sizeof(uint64_t); ++i) {
+            kMer = (kMer << 32 << 32) | kmer_t(MixHash(seed * 4 + i + 1));
+        }
+        return kMer & ((kmer_t(1) << (2 * k)) - kmer_t(1));
+    }
+
+    TEST(CompactSet, InsertContainsErase) {
+        struct TestCase {
+            int k;
+            size_t count;
+        };
+        std::vector<TestCase> tests = {
+                {1, 10},
+                {3, 100},
+                {13, 10000},
+                {31, 50000},
+        };
+        if (sizeof(kmer_t) >= 16) tests.push_back({63, 50000});
+        if (sizeof(kmer_t) >= 32) tests.push_back({127, 20000});
+
+        for (auto t : tests) {
+            CompactKMerSet<kmer_t, kh_wrapper> kMers(wrapper, t.count, t.k);
+            auto want = wrapper.kh_init_set();
+            for (size_t i = 0; i < t.count; ++i) {
+                kmer_t kMer = RandomKMer(i, t.k);
+                int ret;
+                wrapper.kh_put_to_set(want, kMer, &ret);
+                EXPECT_EQ(bool(ret), kMers.Insert(kMer));
+            }
+            EXPECT_EQ(kh_size(want), kMers.Size());
+            for (size_t i = 0; i < 2 * t.count; ++i) {
+                kmer_t kMer = RandomKMer(i, t.k);
+                EXPECT_EQ(wrapper.kh_get_from_set(want, kMer) != kh_end(want), kMers.Contains(kMer));
+            }
+            for (size_t i = 0; i < t.count; i += 2) {
+                kmer_t kMer = RandomKMer(i, t.k);
+                kMers.Erase(kMer);
+                auto key = wrapper.kh_get_from_set(want, kMer);
+                if (key != kh_end(want)) wrapper.kh_del_from_set(want, key);
+            }
+            EXPECT_EQ(kh_size(want), kMers.Size());
+            size_t lastIndex = 0, iterated = 0;
+            for (kmer_t kMer; nextKMer(&kMers, kMer, lastIndex); ++lastIndex) {
+                EXPECT_NE(kh_end(want), wrapper.kh_get_from_set(want, kMer));
+                ++iterated;
+            }
+            EXPECT_EQ(kh_size(want), iterated);
+            wrapper.kh_destroy_set(want);
+        }
+    }
+
+    TEST(CompactSet, Overflow) {
+        // Far more k-mers than expected end up in the overflow table.
+        CompactKMerSet<kmer_t, kh_wrapper> kMers(wrapper, 100, 31);
+        for (size_t i = 0; i < 10000; ++i) kMers.Insert(RandomKMer(i, 31));
+        EXPECT_EQ(10000, kMers.Size());
+        EXPECT_LE(10000 - kMers.SlotsCount(), kMers.OverflowSize());
+        for (size_t i = 0; i < 10000; ++i) EXPECT_TRUE(kMers.Contains(RandomKMer(i, 31)));
+        EXPECT_EQ(62 - 4, kMers.RemainderBits());
+    }
+
+    TEST(CompactSet, ReadKMersInto) {
+        std::string directory = std::filesystem::current_path();
+        directory += "/tests/testdata/";
+        std::vector<std::string> paths = {directory + "test.fa", directory + "runstest.fa"};
+        for (int k : {5, 10}) {
+            for (bool complements : {false, true}) {
+                auto want = wrapper.kh_init_set();
+                for (auto &&path : paths) ReadKMers(want, wrapper, kmer_t(0), path, k, complements);
+                auto wantResult = kMersToVec(want, kmer_t(0));
+                std::sort(wantResult.begin(), wantResult.end());
+                for (int threads : {1, 3}) {
+                    // Expect fewer k-mers than read so that the overflow table is used too.
+                    CompactKMerSet<kmer_t, kh_wrapper> kMers(wrapper, wantResult.size() / 2, k);
+                    ReadKMersInto(kMers, kmer_t(0), paths, k, complements, threads);
+                    std::vector<kmer_t> gotResult;
+                    size_t lastIndex = 0;
+                    for (kmer_t kMer; nextKMer(&kMers, kMer, lastIndex); ++lastIndex) gotResult.push_back(kMer);
+                    std::sort(gotResult.begin(), gotResult.end());
+                    EXPECT_EQ(wantResult, gotResult);
+                }
+                wrapper.kh_destroy_set(want);
+            }
+        }
+    }
+
+    TEST(CompactSet, Local) {
+        struct TestCase {
+            std::vector<kmer_t> kMers;
+            int k;
+            int d_max;
+            bool complements;
+            std::string wantSuperstring;
+        };
+        std::vector<TestCase> tests = {
+                // A single path gives the same superstring regardless of the iteration order.
+                {{KMerToNumber(KMer{"GTT"}), KMerToNumber(KMer{"ACG"}), KMerToNumber(KMer{"TGC"}), KMerToNumber(KMer{"CGT"}),
+                  KMerToNumber(KMer{"GCA"}), KMerToNumber(KMer{"TTG"})}, 3, 2, false, "ACGTTGca"},
+                {{KMerToNumber(KMer{"TTTCTTTTTTTTTTTTTTTTTTTTTTTTTTG"}), KMerToNumber(KMer{"TTCTTTTTTTTTTTTTTTTTTTTTTTTTTGA"})}, 31, 5, false,
+                 "TTtcttttttttttttttttttttttttttga"},
+        };
+
+        for (auto t: tests) {
+            std::stringstream of;
+            CompactKMerSet<kmer_t, kh_wrapper> kMers(wrapper, t.kMers.size(), t.k);
+            for (auto &&kMer : t.kMers) kMers.Insert(kMer);
+
+            Local(&kMers, wrapper, kmer_t (0), of, t.k, t.d_max, t.complements);
+
+            EXPECT_EQ(t.wantSuperstring, of.str());
+            EXPECT_EQ(0, kMers.Size());
+        }
+    }
+}
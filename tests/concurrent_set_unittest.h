@@ -0,0 +1,94 @@
+#pragma once
+#include "../src/concurrent_set.h"
+#include "../src/parser.h"
+#include "../src/parallel.h"
+
+#include "kmer_types.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(ConcurrentSet, InsertContainsErase) {
+        ConcurrentKMerSet<kmer_t> kMers(4);
+        EXPECT_EQ(16, kMers.Capacity());
+        EXPECT_TRUE(kMers.Insert(5));
+        EXPECT_TRUE(kMers.Insert(7));
+        EXPECT_FALSE(kMers.Insert(5));
+        EXPECT_EQ(2, kMers.Size());
+        EXPECT_TRUE(kMers.Contains(5));
+        EXPECT_FALSE(kMers.Contains(6));
+        EXPECT_TRUE(kMers.Erase(5));
+        EXPECT_FALSE(kMers.Erase(5));
+        EXPECT_FALSE(kMers.Erase(6));
+        EXPECT_FALSE(kMers.Contains(5));
+        EXPECT_EQ(1, kMers.Size());
+        // The removed k-mer can be inserted again.
+        EXPECT_TRUE(kMers.Insert(5));
+        EXPECT_TRUE(kMers.Contains(5));
+        EXPECT_EQ(2, kMers.Size());
+
+        size_t lastIndex = 0;
+        std::vector<kmer_t> got;
+        for (kmer_t kMer; nextKMer(&kMers, kMer, lastIndex); ++lastIndex) {
+            got.push_back(kMer);
+        }
+        std::sort(got.begin(), got.end());
+        EXPECT_EQ((std::vector<kmer_t>{5, 7}), got);
+    }
+
+    TEST(ConcurrentSet, Full) {
+        ConcurrentKMerSet<kmer_t> kMers(0);
+        for (kmer_t kMer = 0; kMer < kmer_t(16); ++kMer) kMers.Insert(kMer);
+        EXPECT_THROW(kMers.Insert(16), std::length_error);
+        EXPECT_FALSE(kMers.Contains(16));
+        EXPECT_FALSE(kMers.Erase(16));
+    }
+
+    TEST(ConcurrentSet, Parallel) {
+        size_t count = 1 << 16;
+        int threads = 4;
+        ConcurrentKMerSet<kmer_t> kMers(count);
+        // The threads insert overlapping ranges of k-mers.
+        RunInParallel(threads, [&](int t) {
+            for (size_t i = count * t / (2 * threads); i < count * (t + 2) / (2 * threads); ++i) kMers.Insert(kmer_t(i));
+        });
+        size_t inserted = count * (threads + 1) / (2 * threads);
+        EXPECT_EQ(inserted, kMers.Size());
+        // The threads erase the even k-mers while the odd ones stay present.
+        std::atomic<size_t> erased(0), missing(0);
+        RunInParallel(threads, [&](int t) {
+            for (size_t i = t; i < count; i += threads) {
+                if (i % 2 == 0) erased += kMers.Erase(kmer_t(i));
+                else missing += (i < inserted) != kMers.Contains(kmer_t(i));
+            }
+        });
+        EXPECT_EQ(inserted / 2, erased);
+        EXPECT_EQ(0, missing);
+        EXPECT_EQ(inserted / 2, kMers.Size());
+    }
+
+    TEST(ConcurrentSet, AddKMersParallel) {
+        std::string sequence = "ACGTTGCATGCAtgcaNACGTACCATGCATTGACACACGTTTGCAAACGGGTACCAcgtGGTAC";
+        for (int k : {3, 5, 7}) {
+            for (bool complements : {false, true}) {
+                for (bool case_sensitive : {false, true}) {
+                    auto want = wrapper.kh_init_set();
+                    AddKMers(want, wrapper, kmer_t(0), sequence.size(), sequence.data(), k, complements, case_sensitive);
+                    for (int threads : {1, 3, 8}) {
+                        ConcurrentKMerSet<kmer_t> kMers(sequence.size());
+                        AddKMersParallel(kMers, sequence.size(), sequence.data(), k, complements, case_sensitive, threads);
+                        EXPECT_EQ(kh_size(want), kMers.Size());
+                        for (auto i = kh_begin(want); i != kh_end(want); ++i) {
+                            if (!kh_exist(want, i)) continue;
+                            EXPECT_TRUE(kMers.Contains(kh_key(want, i)));
+                        }
+                    }
+                    wrapper.kh_destroy_set(want);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include "../src/encoding.h"
+
+#include <random>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(Encoding, EncodeNucleotides) {
+        std::string alphabet = "ACGTacgtNnRX>\n\r \xff";
+        std::mt19937 generator(42);
+        for (size_t length : {size_t(1), size_t(15), size_t(33), ENCODING_BLOCK_SIZE}) {
+            for (int repetition = 0; repetition < 100; ++repetition) {
+                std::string sequence(length, 'A');
+                for (auto &&c : sequence) c = alphabet[generator() % alphabet.size()];
+                uint8_t codes[ENCODING_BLOCK_SIZE];
+                uint64_t lowercase;
+
+                uint64_t invalid = EncodeNucleotides(sequence.data(), length, codes, lowercase);
+
+                for (size_t i = 0; i < length; ++i) {
+                    uint8_t want = nucleotideToInt[(uint8_t)sequence[i]];
+                    EXPECT_EQ(want >= 4, (invalid >> i) & 1);
+                    if (want < 4) {
+                        EXPECT_EQ(want, codes[i]);
+                        EXPECT_EQ(sequence[i] > 'Z', (lowercase >> i) & 1);
+                    }
+                }
+                if (length < 64) {
+                    EXPECT_EQ(0, invalid >> length);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include "../src/external.h"
+
+#include "kmer_types.h"
+
+#include <algorithm>
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(External, ForEachSuperKMer) {
+        std::string sequence = "ACGTTGCATTGACCAGTAGGCATTACGGATCCATGACTTTAGCAAGTCACGAT";
+        for (int k : {3, 15, 20, 31}) {
+            for (bool complements : {false, true}) {
+                std::vector<size_t> gotCoverage(sequence.size() - k + 1);
+                size_t lastEnd = 0;
+                ForEachSuperKMer(sequence.data(), sequence.size(), k, complements, 7,
+                                 [&](size_t bucket, size_t start, size_t length) {
+                    EXPECT_LT(bucket, 7);
+                    EXPECT_GE(length, size_t(k));
+                    // Consecutive super-k-mers overlap by k-1 characters.
+                    if (start > 0) {
+                        EXPECT_EQ(lastEnd, start + k - 1);
+                    }
+                    lastEnd = start + length;
+                    for (size_t i = start; i + k <= start + length; ++i) ++gotCoverage[i];
+                });
+                EXPECT_EQ(sequence.size(), lastEnd);
+                EXPECT_EQ(std::vector<size_t>(sequence.size() - k + 1, 1), gotCoverage);
+            }
+        }
+    }
+
+    TEST(External, ForEachSuperKMerComplements) {
+        std::string sequence = "ACGTTGCATTGACCAGTAGGCATTACGGATCCATGACTTTAGCAAGTCACGAT";
+        std::string reverseComplement = "ATCGTGACTTGCTAAAGTCATGGATCCGTAATGCCTACTGGTCAATGCAACGT";
+        int k = 20;
+        auto bucketsOf = [&](std::string &s) {
+            std::vector<size_t> buckets;
+            ForEachSuperKMer(s.data(), s.size(), k, true, 13, [&](size_t bucket, size_t start, size_t length) {
+                for (size_t i = start; i + k <= start + length; ++i) buckets.push_back(bucket);
+            });
+            return buckets;
+        };
+
+        auto gotBuckets = bucketsOf(sequence);
+        auto gotComplementBuckets = bucketsOf(reverseComplement);
+        std::reverse(gotComplementBuckets.begin(), gotComplementBuckets.end());
+
+        EXPECT_EQ(gotBuckets, gotComplementBuckets);
+    }
+
+    TEST(External, ForEachSuperKMerShort) {
+        size_t calls = 0;
+        ForEachSuperKMer("ACG", 3, 4, false, 7, [&](size_t, size_t, size_t) { ++calls; });
+        EXPECT_EQ(0, calls);
+    }
+
+#ifdef __unix__
+    TEST(External, ReadKMersExternal) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/test.fa";
+        std::string directory = std::filesystem::temp_directory_path();
+        for (int k : {2, 5, 10}) {
+            for (bool complements : {false, true}) {
+                auto kMers = wrapper.kh_init_set();
+                ReadKMers(kMers, wrapper, kmer_t (0), path, k, complements);
+                auto wantResult = kMersToVec(kMers, kmer_t(0));
+                std::sort(wantResult.begin(), wantResult.end());
+                wrapper.kh_destroy_set(kMers);
+                for (int threads : {1, 3}) {
+                    std::vector<kmer_t> gotResult;
+                    std::vector<std::string> paths = {path};
+                    ReadKMersExternal(wrapper, kmer_t(0), paths, k, complements, directory, threads, [&](auto *bucket) {
+                        auto bucketVec = kMersToVec(bucket, kmer_t(0));
+                        gotResult.insert(gotResult.end(), bucketVec.begin(), bucketVec.end());
+                    });
+                    std::sort(gotResult.begin(), gotResult.end());
+
+                    EXPECT_EQ(wantResult, gotResult);
+                }
+            }
+        }
+    }
+#endif
+}
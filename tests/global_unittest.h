@@ -151,4 +151,99 @@ namespace {
             EXPECT_EQ(t.wantResult, of.str());
         }
     }
+
+    TEST(Global, OverlapHamiltonianPathParallel) {
+        int k = 11;
+        std::vector<kmer_t> kMers;
+        for (size_t i = 0; i < 5000; ++i) kMers.push_back(kmer_t(MixHash(i) & ((1 << (2 * k)) - 1)));
+        std::sort(kMers.begin(), kMers.end());
+        kMers.erase(std::unique(kMers.begin(), kMers.end()), kMers.end());
+        for (bool complements : {false, true}) {
+            std::vector<kmer_t> input;
+            for (auto &&kMer : kMers) if (!complements || kMer < ReverseComplement(kMer, k)) input.push_back(kMer);
+            for (int memoryReductionFactor : {1, 16}) {
+                MEMORY_REDUCTION_FACTOR = memoryReductionFactor;
+                for (bool lower_bound : {false, true}) {
+                    overlapPath want = OverlapHamiltonianPath(wrapper, input, k, complements, lower_bound);
+                    for (int threads : {2, 3, 8}) {
+                        overlapPath got = OverlapHamiltonianPath(wrapper, input, k, complements, lower_bound, threads);
+                        EXPECT_EQ(want.first, got.first);
+                        EXPECT_EQ(want.second, got.second);
+                    }
+                }
+            }
+        }
+        MEMORY_REDUCTION_FACTOR = 16;
+    }
+
+    TEST(Global, PlanParts) {
+        size_t kMersCount = 1 << 20;
+        EXPECT_EQ(1, PlanParts<kmer_t>(kMersCount, kMersCount, SIZE_MAX, 1));
+        EXPECT_EQ(MAX_MEMORY_PARTS, PlanParts<kmer_t>(kMersCount, kMersCount, 0, 1));
+        // The memory of a single part must fit, while fewer parts do not. With two threads, both next and order are needed.
+        size_t available = 2 * PrefixMapMemory<kmer_t>(kMersCount / 8 / 2) + (kMersCount / 8 + 1) * 8;
+        size_t parts = PlanParts<kmer_t>(kMersCount, kMersCount, available, 2);
+        ASSERT_GT(parts, 1);
+        EXPECT_LE(parts, 8);
+        EXPECT_LE(2 * PrefixMapMemory<kmer_t>(kMersCount / parts / 2) + (kMersCount / parts + 1) * 8, available);
+        EXPECT_GT(2 * PrefixMapMemory<kmer_t>(kMersCount / (parts - 1) / 2) + (kMersCount / (parts - 1) + 1) * 8, available);
+        // With fewer allowed prefixes, fewer parts are needed.
+        EXPECT_LT(PlanParts<kmer_t>(kMersCount, kMersCount / 4, available, 2), parts);
+    }
+
+    TEST(Global, OverlapHamiltonianPathMaxMemory) {
+        int k = 11;
+        std::vector<kmer_t> kMers;
+        for (size_t i = 0; i < 5000; ++i) kMers.push_back(kmer_t(MixHash(i) & ((1 << (2 * k)) - 1)));
+        std::sort(kMers.begin(), kMers.end());
+        kMers.erase(std::unique(kMers.begin(), kMers.end()), kMers.end());
+        for (bool complements : {false, true}) {
+            std::vector<kmer_t> input;
+            for (auto &&kMer : kMers) if (!complements || kMer < ReverseComplement(kMer, k)) input.push_back(kMer);
+            // With enough memory, the prefixes are processed at once.
+            MEMORY_REDUCTION_FACTOR = 1;
+            overlapPath want = OverlapHamiltonianPath(wrapper, input, k, complements);
+            MEMORY_REDUCTION_FACTOR = 16;
+            overlapPath got = OverlapHamiltonianPath(wrapper, input, k, complements, false, 2, size_t(1) << 30);
+            EXPECT_EQ(want.first, got.first);
+            EXPECT_EQ(want.second, got.second);
+            // With too little memory, the most parts are used, which still gives a Hamiltonian path.
+            got = OverlapHamiltonianPath(wrapper, input, k, complements, false, 1, 1);
+            size_t edges = 0;
+            for (size_t i = 0; i < got.first.size(); ++i) edges += got.first[i] != size_t(-1);
+            EXPECT_EQ(got.first.size() - 1 - complements, edges);
+        }
+    }
+
+    TEST(Global, OverlapHamiltonianPathMergeJoin) {
+        // Dense k-mers with small k give large groups of equal prefixes, sparse ones give mostly short overlaps.
+        for (auto [k, count] : {std::pair<int, size_t>{5, 600}, {6, 3000}, {11, 5000}}) {
+            for (bool complements : {false, true}) {
+                std::vector<kmer_t> input;
+                std::vector<bool> seen(size_t(1) << (2 * k), false);
+                // Keep the k-mers unsorted, so that the order of the k-mers with equal prefixes matters.
+                for (size_t i = 0; i < count; ++i) {
+                    kmer_t kMer = kmer_t(MixHash(i) & ((1 << (2 * k)) - 1));
+                    if (complements && ReverseComplement(kMer, k) < kMer) kMer = ReverseComplement(kMer, k);
+                    if (!seen[(uint64_t)kMer]) input.push_back(kMer);
+                    seen[(uint64_t)kMer] = true;
+                }
+                for (int memoryReductionFactor : {1, 16}) {
+                    MEMORY_REDUCTION_FACTOR = memoryReductionFactor;
+                    for (bool lower_bound : {false, true}) {
+                        overlapPath want = OverlapHamiltonianPath(wrapper, input, k, complements, lower_bound);
+                        overlapPath got = OverlapHamiltonianPathMergeJoin(input, k, complements, lower_bound);
+                        EXPECT_EQ(want.first, got.first);
+                        EXPECT_EQ(want.second, got.second);
+                        auto inputCopy = input;
+                        PackedKMerArray<kmer_t> packed(inputCopy, k);
+                        overlapPath gotPacked = OverlapHamiltonianPathMergeJoin(packed, k, complements, lower_bound);
+                        EXPECT_EQ(want.first, gotPacked.first);
+                        EXPECT_EQ(want.second, gotPacked.second);
+                    }
+                }
+            }
+        }
+        MEMORY_REDUCTION_FACTOR = 16;
+    }
 }
@@ -0,0 +1,59 @@
+#pragma once
+#include "../src/hyperloglog.h"
+#include "../src/parser.h"
+
+#include "kmer_types.h"
+
+#include <cmath>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(HyperLogLog, Estimate) {
+        EXPECT_EQ(0, HyperLogLog().Estimate());
+        for (uint64_t count : {10, 1000, 30000, 1000000}) {
+            HyperLogLog sketch;
+            // Each element is added twice, which must not change the estimate.
+            for (uint64_t i = 0; i < 2 * count; ++i) sketch.Add(MixHash(i % count));
+            // The standard error with 2^14 registers is about 0.8 %.
+            EXPECT_NEAR(count, sketch.Estimate(), std::max(1.0, 0.03 * count));
+        }
+    }
+
+    TEST(HyperLogLog, Merge) {
+        HyperLogLog a, b;
+        for (uint64_t i = 0; i < 200000; ++i) a.Add(MixHash(i));
+        for (uint64_t i = 100000; i < 400000; ++i) b.Add(MixHash(i));
+        a.Merge(b);
+        EXPECT_NEAR(400000, a.Estimate(), 0.03 * 400000);
+    }
+
+// Retrieving current path on Windows does not work as on linux
+// therefore the following unittest is linux-specific.
+#ifdef __unix__
+    TEST(HyperLogLog, EstimateDistinctKMers) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/test.fa";
+        struct TestCase {
+            int k;
+            bool complements;
+            size_t wantResult;
+        };
+        std::vector<TestCase> tests = {
+                {10, true, 3},
+                {5, true, 11},
+                {5, false, 11},
+                {2, false, 11},
+        };
+        for (auto &t : tests) {
+            for (std::string suffix : {"", ".gz", ".bgz"}) {
+                std::vector<std::string> paths = {path + suffix};
+                EXPECT_EQ(t.wantResult, EstimateDistinctKMers(kmer_t(0), paths, t.k, t.complements));
+            }
+        }
+        std::vector<std::string> stdinPaths = {"-"};
+        EXPECT_EQ(0, EstimateDistinctKMers(kmer_t(0), stdinPaths, 5, false));
+    }
+#endif
+}
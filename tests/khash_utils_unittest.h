@@ -0,0 +1,46 @@
+#pragma once
+#include "../src/khash_utils.h"
+#include "../src/swiss_table.h"
+
+#include "kmer_types.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(KHashUtils, Prefetch) {
+        int k = 13;
+        for (bool complements : {false, true}) {
+            swiss_dict_t<kmer_t> swissWrapper;
+            auto *kMers = wrapper.kh_init_set();
+            auto *swissKMers = swissWrapper.kh_init_set();
+            auto *map = wrapper.kh_init_map();
+            for (size_t i = 0; i < 1000; i += 2) {
+                kmer_t kMer = kmer_t(MixHash(i)) & KMerMask<kmer_t>(k);
+                int ret;
+                wrapper.kh_put_to_set(kMers, kMer, &ret);
+                swissWrapper.kh_put_to_set(swissKMers, kMer, &ret);
+                auto key = wrapper.kh_put_to_map(map, kMer, &ret);
+                kh_value(map, key) = i;
+            }
+            // Prefetching the buckets changes neither the sets nor the results of the lookups.
+            for (size_t i = 0; i < 1000; ++i) {
+                kmer_t kMer = kmer_t(MixHash(i)) & KMerMask<kmer_t>(k);
+                wrapper.kh_prefetch_set(kMers, kMer);
+                swissWrapper.kh_prefetch_set(swissKMers, kMer);
+                wrapper.kh_prefetch_map(map, kMer);
+                bool want = wrapper.kh_get_from_set(kMers, kMer) != kh_end(kMers);
+                if (complements) want |= wrapper.kh_get_from_set(kMers, ReverseComplement(kMer, k)) != kh_end(kMers);
+                EXPECT_EQ(want, containsKMer(kMers, wrapper, kMer, k, complements));
+                EXPECT_EQ(want, containsKMer(swissKMers, swissWrapper, kMer, k, complements));
+                if (i % 2 == 0) {
+                    EXPECT_EQ(i, kh_val(map, wrapper.kh_get_from_map(map, kMer)));
+                }
+            }
+            EXPECT_EQ(500, kh_size(kMers));
+            EXPECT_EQ(500, kh_size(swissKMers));
+            wrapper.kh_destroy_set(kMers);
+            swissWrapper.kh_destroy_set(swissKMers);
+            wrapper.kh_destroy_map(map);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "../src/kmers.h"
+#include "../src/khash_utils.h"
+#include "../src/uint256_t/uint256_t.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    kmer256_t FromUint256(uint256_t value) {
+        return kmer256_t(value.lower(), value.upper());
+    }
+
+    TEST(KMer256, Arithmetic) {
+        // Compare with the general 256-bit integers.
+        uint256_t a = (uint256_t(MixHash(1)) << 192) | (uint256_t(MixHash(2)) << 128) | (uint256_t(MixHash(3)) << 64) | uint256_t(MixHash(4));
+        uint256_t b = (uint256_t(MixHash(5)) << 128) | uint256_t(~uint64_t(0));
+        kmer256_t x = FromUint256(a), y = FromUint256(b);
+        EXPECT_EQ(FromUint256(a + b), x + y);
+        EXPECT_EQ(FromUint256(a - b), x - y);
+        EXPECT_EQ(FromUint256(b - a), y - x);
+        EXPECT_EQ(FromUint256(a & b), x & y);
+        EXPECT_EQ(FromUint256(a | b), x | y);
+        EXPECT_EQ(FromUint256(a ^ b), x ^ y);
+        EXPECT_EQ(FromUint256(~a), ~x);
+        for (int shift : {0, 1, 2, 63, 64, 65, 127, 128, 129, 200, 254, 255, 256, 300}) {
+            EXPECT_EQ(FromUint256(shift >= 256 ? uint256_t(0) : a << shift), x << shift);
+            EXPECT_EQ(FromUint256(shift >= 256 ? uint256_t(0) : a >> shift), x >> shift);
+            EXPECT_EQ(x << shift, x << kmer256_t(shift));
+            EXPECT_EQ(x >> shift, x >> kmer256_t(shift));
+        }
+        EXPECT_TRUE(y < x);
+        EXPECT_FALSE(x < x);
+        EXPECT_TRUE(x <= x);
+        EXPECT_EQ(kmer256_t(~__uint128_t(0), ~__uint128_t(0)), kmer256_t(-1));
+        kmer256_t counter = kmer256_t(~__uint128_t(0), 0);
+        ++counter;
+        EXPECT_EQ(kmer256_t(0, 1), counter);
+        EXPECT_FALSE(bool(kmer256_t(0)));
+        EXPECT_EQ(42, uint64_t(kmer256_t(42)));
+    }
+
+    TEST(KMer256, BitPrefixSuffix) {
+        uint256_t a = (uint256_t(MixHash(7)) << 192) | (uint256_t(MixHash(8)) << 128) | (uint256_t(MixHash(9)) << 64) | uint256_t(MixHash(10));
+        kmer256_t x = FromUint256(a);
+        for (int d : {0, 1, 31, 32, 63, 64, 65, 100, 127}) {
+            EXPECT_EQ(FromUint256(a & ((uint256_t(1) << (2 * d)) - uint256_t(1))), BitSuffix(x, d));
+            EXPECT_EQ(FromUint256(a >> (2 * (127 - d))), BitPrefix(x, 127, d));
+        }
+        EXPECT_EQ(kmer256_t(-1), kmer256_t::LowMask(256));
+    }
+
+    TEST(KMer256, Hash) {
+        // The hash is the same as the one of the general 256-bit integers so that the output does not change.
+        uint256_t a = (uint256_t(MixHash(11)) << 192) | (uint256_t(MixHash(12)) << 128) | (uint256_t(MixHash(13)) << 64) | uint256_t(MixHash(14));
+        EXPECT_EQ(kh_int128_hash_func((__uint128_t)((a >> 129) ^ a ^ (a << 35))), kh_int256_hash_func(FromUint256(a)));
+    }
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include "../src/kmer_set.h"
+
+#include "kmer_types.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <filesystem>
+
+#include "gtest/gtest.h"
+
+namespace {
+#ifdef __unix__
+    TEST(KMerSet, WriteAndLoad) {
+        std::string fastaPath = std::filesystem::current_path();
+        fastaPath += "/tests/testdata/test.fa";
+        std::string path = std::filesystem::temp_directory_path() / "kmercamel_test.kmers";
+        for (int k : {2, 5, 10}) {
+            for (bool complements : {false, true}) {
+                auto kMers = wrapper.kh_init_set();
+                ReadKMers(kMers, wrapper, kmer_t(0), fastaPath, k, complements);
+                auto wantResult = kMersToVec(kMers, kmer_t(0));
+                std::sort(wantResult.begin(), wantResult.end());
+                auto kMerVec = kMersToVec(kMers, kmer_t(0));
+                std::ofstream of(path, std::ios::binary);
+                WriteKMerSet(kMerVec, k, complements, of);
+                of.close();
+
+                EXPECT_TRUE(IsKMerSetFile(path));
+                KMerSetHeader header;
+                ASSERT_TRUE(ReadKMerSetHeader(path, header));
+                EXPECT_TRUE(IsCompleteKMerSetFile(path, header, kmer_t(0)));
+                EXPECT_EQ(k, header.k);
+                EXPECT_EQ(complements, header.complements);
+                EXPECT_EQ(sizeof(kmer_t), header.width);
+                EXPECT_EQ(wantResult.size(), header.count);
+                auto gotResult = LoadKMerSet(path, kmer_t(0));
+                EXPECT_EQ(wantResult, gotResult);
+
+                auto gotSet = wrapper.kh_init_set();
+                KMersToSet(gotSet, wrapper, gotResult);
+                EXPECT_EQ(kh_size(kMers), kh_size(gotSet));
+                for (auto &&kMer : wantResult) EXPECT_NE(kh_end(kMers), wrapper.kh_get_from_set(gotSet, kMer));
+                wrapper.kh_destroy_set(gotSet);
+                wrapper.kh_destroy_set(kMers);
+            }
+        }
+        std::filesystem::remove(path);
+    }
+
+    TEST(KMerSet, LoadCorrupted) {
+        std::string path = std::filesystem::temp_directory_path() / "kmercamel_test_corrupted.kmers";
+        std::vector<kmer_t> kMers = {kmer_t(1), kmer_t(2), kmer_t(3)};
+        std::stringstream data;
+        WriteKMerSet(kMers, 5, false, data);
+        std::string truncated = data.str().substr(0, data.str().size() - 1);
+        std::ofstream(path, std::ios::binary) << truncated;
+
+        EXPECT_TRUE(IsKMerSetFile(path));
+        KMerSetHeader header;
+        ASSERT_TRUE(ReadKMerSetHeader(path, header));
+        EXPECT_FALSE(IsCompleteKMerSetFile(path, header, kmer_t(0)));
+        EXPECT_THROW(LoadKMerSet(path, kmer_t(0)), std::invalid_argument);
+        // A file cut inside the header is not a complete k-mer set file either.
+        std::ofstream(path, std::ios::binary) << truncated.substr(0, sizeof(KMerSetHeader) - 1);
+        EXPECT_TRUE(IsKMerSetFile(path));
+        EXPECT_FALSE(ReadKMerSetHeader(path, header));
+        std::filesystem::remove(path);
+    }
+
+    TEST(KMerSet, IsKMerSetFile) {
+        std::string path = std::filesystem::current_path();
+        EXPECT_FALSE(IsKMerSetFile(path + "/tests/testdata/test.fa"));
+        EXPECT_FALSE(IsKMerSetFile(path + "/tests/testdata/test.fa.gz"));
+        EXPECT_FALSE(IsKMerSetFile(path + "/tests/testdata/nonexistent.fa"));
+        EXPECT_FALSE(IsKMerSetFile("-"));
+    }
+#endif
+}
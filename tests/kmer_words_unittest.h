@@ -0,0 +1,103 @@
+#pragma once
+#include "../src/kmer_words.h"
+#include "../src/uint256_t/uint256_t.h"
+#include "../src/global.h"
+#include "../src/local.h"
+
+#include <sstream>
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace {
+    /// Return a random-looking nucleotide sequence of the given length.
+    std::string LongSequence(size_t length) {
+        std::string sequence(length, 'A');
+        for (size_t i = 0; i < length; ++i) sequence[i] = letters[MixHash(i) % 4];
+        return sequence;
+    }
+
+    TEST(KMerWords, Arithmetic) {
+        // Compare with the 256-bit integers whose lower words match.
+        uint256_t a = (uint256_t(MixHash(1)) << 192) | (uint256_t(MixHash(2)) << 128) | (uint256_t(MixHash(3)) << 64) | uint256_t(MixHash(4));
+        uint256_t b = (uint256_t(MixHash(5)) << 128) | uint256_t(MixHash(6));
+        auto toWords = [](uint256_t value) {
+            kmer_words<4> result;
+            for (int i = 0; i < 4; ++i) result.words[i] = uint64_t(value >> (64 * i));
+            return result;
+        };
+        kmer_words<4> x = toWords(a), y = toWords(b);
+        EXPECT_EQ(toWords(a + b), x + y);
+        EXPECT_EQ(toWords(a - b), x - y);
+        EXPECT_EQ(toWords(b - a), y - x);
+        EXPECT_EQ(toWords(a & b), x & y);
+        EXPECT_EQ(toWords(a | b), x | y);
+        EXPECT_EQ(toWords(a ^ b), x ^ y);
+        EXPECT_EQ(toWords(~a), ~x);
+        for (int shift : {0, 1, 2, 63, 64, 65, 127, 128, 200, 255, 256, 300}) {
+            EXPECT_EQ(toWords(shift >= 256 ? uint256_t(0) : a << shift), x << shift);
+            EXPECT_EQ(toWords(shift >= 256 ? uint256_t(0) : a >> shift), x >> shift);
+        }
+        EXPECT_TRUE(y < x);
+        EXPECT_FALSE(x < x);
+        EXPECT_TRUE(x <= x);
+        EXPECT_EQ(kmer_words<4>(0) - kmer_words<4>(1), kmer_words<4>(-1));
+        kmer_words<4> counter = ~uint64_t(0);
+        ++counter;
+        EXPECT_EQ(kmer_words<4>(1) << 64, counter);
+        EXPECT_FALSE(bool(kmer_words<4>(0)));
+        EXPECT_EQ(42, uint64_t(kmer_words<4>(42)));
+    }
+
+    TEST(KMerWords, ReverseComplement) {
+        for (int k : {128, 151, 160, 201}) {
+            std::string sequence = LongSequence(k);
+            std::string complement(sequence.rbegin(), sequence.rend());
+            for (char &c : complement) c = ComplementaryNucleotide(c);
+            kmer_words<7> kMer(0), want(0);
+            for (int i = 0; i < k; ++i) {
+                kMer = (kMer << 2) | kmer_words<7>(NucleotideToInt(sequence[i]));
+                want = (want << 2) | kmer_words<7>(NucleotideToInt(complement[i]));
+            }
+            EXPECT_EQ(want, ReverseComplement(kMer, k));
+            EXPECT_EQ(complement, NumberToKMer(ReverseComplement(kMer, k), k));
+        }
+    }
+
+    TEST(KMerWords, Global) {
+        // A sequence of 200 k-mers of length 151 is covered by a single superstring.
+        int k = 151;
+        std::string sequence = LongSequence(350);
+        std::vector<kmer320_t> kMers;
+        kmer320_t mask = (kmer320_t(1) << (2 * k)) - kmer320_t(1), kMer(0);
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            kMer = ((kMer << 2) | kmer320_t(NucleotideToInt(sequence[i]))) & mask;
+            if (i + 1 >= size_t(k)) kMers.push_back(kMer);
+        }
+        std::stringstream of;
+        Global(kmer_dict320_t(), kMers, of, k, false);
+        std::string got = of.str();
+        for (char &c : got) c = toupper(c);
+        EXPECT_EQ(sequence, got);
+    }
+
+    TEST(KMerWords, Local) {
+        int k = 201;
+        std::string sequence = LongSequence(300);
+        kmer_dict448_t wrapper448;
+        auto *kMers = wrapper448.kh_init_set();
+        kmer448_t mask = (kmer448_t(1) << (2 * k)) - kmer448_t(1), kMer(0);
+        int ret;
+        for (size_t i = 0; i < sequence.size(); ++i) {
+            kMer = ((kMer << 2) | kmer448_t(NucleotideToInt(sequence[i]))) & mask;
+            if (i + 1 >= size_t(k)) wrapper448.kh_put_to_set(kMers, kMer, &ret);
+        }
+        std::stringstream of;
+        Local(kMers, wrapper448, kmer448_t(0), of, k, 5, false);
+        std::string got = of.str();
+        for (char &c : got) c = toupper(c);
+        EXPECT_EQ(sequence, got);
+        EXPECT_EQ(0, kh_size(kMers));
+        wrapper448.kh_destroy_set(kMers);
+    }
+}
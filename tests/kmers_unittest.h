@@ -15,12 +15,31 @@ namespace {
         EXPECT_EQ(0b111111'11111110LL, BitSuffix(0b111111'01111111'11111111'11111111'11111111'11111111'11111111'11111110LL, 7));
     }
 
+    TEST(KMers, KMerMask) {
+        EXPECT_EQ(0b111111u, KMerMask<kmer32_t>(3));
+        EXPECT_EQ(kmer32_t(-1), KMerMask<kmer32_t>(16));
+        EXPECT_EQ(kmer64_t(-1) >> 2, KMerMask<kmer64_t>(31));
+        EXPECT_EQ(kmer64_t(-1), KMerMask<kmer64_t>(32));
+        EXPECT_EQ(kmer128_t(-1), KMerMask<kmer128_t>(64));
+    }
+
+    TEST(KMers, FullWidthReverseComplement) {
+        // The k-mers fill the whole integer.
+        EXPECT_EQ(kmer32_t(-1), ReverseComplement(kmer32_t(0), 16));
+        EXPECT_EQ(kmer64_t(-1), ReverseComplement(kmer64_t(0), 32));
+        EXPECT_EQ(KMerToNumber({"ACGTTGCAACGTTGCA"}), ReverseComplement(kmer32_t(KMerToNumber({"TGCAACGTTGCAACGT"})), 16));
+        EXPECT_EQ(KMerToNumber({"AACCGGTTAAACCCGGGTTTACGTACGTACGT"}),
+                  ReverseComplement(KMerToNumber({"ACGTACGTACGTAAACCCGGGTTTAACCGGTT"}), 32));
+    }
+
     TEST(KMers, BitPrefix) {
         EXPECT_EQ(0b110001, BitPrefix(0b1100011110, 5, 3));
         EXPECT_EQ(0b1110, BitPrefix(0b1110, 2, 2));
         EXPECT_EQ(0b0, BitPrefix(0b1110, 2, 0));
         EXPECT_EQ(0b111111'01111111'11111111'11111111'11111111'11111111LL, BitPrefix(0b111111'01111111'11111111'11111111'11111111'11111111'11111111'11111110LL, 31, 23));
         EXPECT_EQ(0b111111'01111111LL, BitPrefix(0b111111'01111111'11111111'11111111'11111111'11111111'11111111'11111110LL, 31, 7));
+        EXPECT_EQ(0, BitPrefix(kmer64_t(-1), 32, 0));
+        EXPECT_EQ(0, BitPrefix(kmer32_t(-1), 16, 0));
     }
 
     TEST(KMers, NucleotideToInt) {
@@ -123,6 +123,8 @@ namespace {
                 {{KMerToNumber(KMer{"TAA"}), KMerToNumber(KMer{"AAA"}), KMerToNumber(KMer{"GCT"})}, 3, 2, false, "GcTAaa"},
                 {{KMerToNumber(KMer{"TTTCTTTTTTTTTTTTTTTTTTTTTTTTTTG"}), KMerToNumber(KMer{"TTCTTTTTTTTTTTTTTTTTTTTTTTTTTGA"})}, 31, 5, false,
                  "TTtcttttttttttttttttttttttttttga"},
+                // The k-mer has all the bits set for 64-bit k-mers.
+                {{KMerToNumber(KMer{"TTTTTTTTTTTTTTTTTTTTTTTTTTTTTTTT"})}, 32, 5, false, "Tttttttttttttttttttttttttttttttt"},
         };
 
         for (auto t: tests) {
@@ -136,4 +138,17 @@ namespace {
             EXPECT_EQ(t.wantSuperstring, of.str());
         }
     }
+
+    TEST(Local, NarrowKMers) {
+        kmer_dict32_t wrapper32;
+        auto kMers = wrapper32.kh_init_set();
+        int ret;
+        // The last k-mer has all the bits set.
+        for (auto &&kMer : {"ATTTTTTTTTTTTTTT", "TTTTTTTTTTTTTTTT"}) wrapper32.kh_put_to_set(kMers, kmer32_t(KMerToNumber(KMer{kMer})), &ret);
+        std::stringstream of;
+        Local(kMers, wrapper32, kmer32_t(0), of, 16, 5, false);
+        EXPECT_EQ(17, of.str().size());
+        EXPECT_EQ(0, kh_size(kMers));
+        wrapper32.kh_destroy_set(kMers);
+    }
 }
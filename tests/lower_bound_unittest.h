@@ -33,6 +33,7 @@ namespace {
             auto gotResult = LowerBoundLength(wrapper, t.kMers, t.k, t.complements);
 
             ASSERT_EQ(t.wantResult, gotResult);
+            EXPECT_EQ(t.wantResult, LowerBoundLengthMergeJoin(t.kMers, t.k, t.complements));
         }
     }
 }
\ No newline at end of file
@@ -64,6 +64,59 @@ namespace {
         }
     }
 
+    TEST(Masks, OptimizeOnesParallel) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/masktest.fa";
+
+        struct TestCase {
+            std::vector<kmer_t> kMers;
+            int k;
+            bool complements;
+            bool minimize;
+            int threads;
+            std::string wantResult;
+        };
+        std::vector<TestCase> tests = {
+                {
+                    {KMerToNumber({"ACG"}), KMerToNumber({"CGT"}), KMerToNumber({"TAA"})},
+                    3, false, true, 3,
+                    "> superstring\nACgTaacgt\n"
+                },
+                {
+                    {KMerToNumber({"ACG"}), KMerToNumber({"CGT"}), KMerToNumber({"TAA"})},
+                    3, false, false, 1,
+                    "> superstring\nACgTaACgt\n"
+                },
+                {
+                    {KMerToNumber({"ACG"}), KMerToNumber({"CGT"}), KMerToNumber({"TAA"})},
+                    3, false, false, 4,
+                    "> superstring\nACgTaACgt\n"
+                },
+                {
+                    {KMerToNumber({"ACG"}), KMerToNumber({"TAA"})},
+                    3, true, true, 2,
+                    "> superstring\nAcgTaacgt\n"
+                },
+                {
+                    {KMerToNumber({"ACG"}), KMerToNumber({"TAA"})},
+                    3, true, false, 3,
+                    "> superstring\nACgTaACgt\n"
+                },
+        };
+
+        for (auto &t : tests) {
+            std::stringstream of;
+            auto masked_superstring = ReadMaskedSuperstring(path);
+            ConcurrentKMerSet<kmer_t> kMers(t.kMers.size());
+            for (auto &kMer : t.kMers) kMers.Insert(kMer);
+
+            OptimizeOnesParallel(masked_superstring, of, kMers, t.k, t.complements, t.minimize, t.threads);
+            kseq_destroy(masked_superstring);
+
+            EXPECT_EQ(t.wantResult, of.str());
+        }
+    }
+
     TEST(Mask, OptimizeRuns) {
         std::string path = std::filesystem::current_path();
 
@@ -0,0 +1,90 @@
+#pragma once
+#include "../src/packed_array.h"
+#include "../src/global.h"
+
+#include <sstream>
+
+#include "kmer_types.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    /// Return pseudo-random k-mers which fit into the given k.
+    std::vector<kmer_t> RandomKMers(size_t count, int k) {
+        std::vector<kmer_t> kMers(count);
+        for (size_t i = 0; i < count; ++i) {
+            kmer_t kMer = 0;
+            for (int j = 0; j < k; j += 16) kMer = (kMer << 32) | kmer_t(MixHash(i * 131 + j) & 0xFFFFFFFF);
+            kMers[i] = kMer & KMerMask<kmer_t>(k);
+        }
+        return kMers;
+    }
+
+    TEST(PackedKMerArray, SetGet) {
+        int maxK = sizeof(kmer_t) * 4;
+        for (int k : {1, 3, 4, 5, 13, maxK / 2 + 1, maxK - 1, maxK}) {
+            auto kMers = RandomKMers(1000, k);
+            PackedKMerArray<kmer_t> packed(kMers.size(), k);
+            EXPECT_EQ(kMers.size(), packed.size());
+            // Write in reverse so that the following k-mers are already stored when a k-mer is written.
+            for (size_t i = kMers.size(); i-- > 0; ) packed.Set(i, kMers[i]);
+            for (size_t i = 0; i < kMers.size(); ++i) EXPECT_EQ(kMers[i], packed[i]);
+            PackedKMerArray<kmer_t> fromVector(kMers, k);
+            EXPECT_TRUE(kMers.empty());
+            for (size_t i = 0; i < packed.size(); ++i) EXPECT_EQ(packed[i], fromVector[i]);
+        }
+        EXPECT_EQ(3, PackedKMerArray<kmer_t>::BytesPerKMer(12));
+        EXPECT_EQ(4, PackedKMerArray<kmer_t>::BytesPerKMer(13));
+        EXPECT_FALSE(PackedKMerArray<kmer_t>::SavesMemory(maxK));
+    }
+
+    TEST(PackedIndexArray, SetGet) {
+        EXPECT_EQ(4, PackedIndexArray::BytesPerIndex(UINT32_MAX - 1));
+        EXPECT_EQ(5, PackedIndexArray::BytesPerIndex(UINT32_MAX));
+        for (size_t maxIndex : {size_t(1000), size_t(UINT32_MAX), size_t(1) << 39}) {
+            PackedIndexArray indices(1000, maxIndex);
+            EXPECT_EQ(1000, indices.size());
+            for (size_t i = 0; i < indices.size(); ++i) EXPECT_EQ(size_t(-1), indices[i]);
+            // Write in reverse so that the following indices are already stored when an index is written.
+            for (size_t i = indices.size(); i-- > 0; ) indices[i] = i % 3 ? maxIndex - i : size_t(-1);
+            for (size_t i = 0; i < indices.size(); ++i) EXPECT_EQ(i % 3 ? maxIndex - i : size_t(-1), indices[i]);
+            indices[1] = indices[0];
+            EXPECT_EQ(size_t(-1), indices[1]);
+            EXPECT_EQ(maxIndex - 2, indices[2]);
+            PackedIndexArray filled(3, maxIndex, 7);
+            EXPECT_EQ(PackedIndexArray({7, 7, 7}), filled);
+            EXPECT_NE(PackedIndexArray({7, 7}), filled);
+        }
+    }
+
+    TEST(PackedKMerArray, PartialPreSort) {
+        for (int k : {3, 13}) {
+            auto kMers = RandomKMers(1000, k);
+            auto want = kMers;
+            PartialPreSort(want, k);
+            auto got = PartialPreSortPacked(kMers, k);
+            EXPECT_TRUE(kMers.empty());
+            ASSERT_EQ(want.size(), got.size());
+            for (size_t i = 0; i < want.size(); ++i) EXPECT_EQ(want[i], got[i]);
+        }
+    }
+
+    TEST(PackedKMerArray, Global) {
+        for (bool complements : {false, true}) {
+            int k = 11;
+            std::vector<kmer_t> kMers;
+            for (auto &&kMer : RandomKMers(300, k)) {
+                if (!complements || kMer < ReverseComplement(kMer, k)) kMers.push_back(kMer);
+            }
+            std::sort(kMers.begin(), kMers.end());
+            kMers.erase(std::unique(kMers.begin(), kMers.end()), kMers.end());
+            std::stringstream want, got;
+            PackedKMerArray<kmer_t> packed(kMers, k);
+            std::vector<kmer_t> unpacked(packed.size());
+            for (size_t i = 0; i < packed.size(); ++i) unpacked[i] = packed[i];
+            Global(wrapper, unpacked, want, k, complements);
+            Global(wrapper, packed, got, k, complements);
+            EXPECT_EQ(want.str(), got.str());
+        }
+    }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "../src/parallel.h"
+
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(Parallel, BlockingQueue) {
+        BlockingQueue<int> queue(2);
+        std::thread producer([&] {
+            for (int i = 0; i < 100; ++i) queue.Push(i);
+            queue.Close();
+        });
+        std::vector<int> got;
+        int item;
+        while (queue.Pop(item)) got.push_back(item);
+        producer.join();
+
+        ASSERT_EQ(100, got.size());
+        for (int i = 0; i < 100; ++i) EXPECT_EQ(i, got[i]);
+    }
+}
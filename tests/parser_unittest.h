@@ -54,16 +54,169 @@ namespace {
         };
 
         for (auto &t: tests) {
-            auto kMers  = wrapper.kh_init_set();
+            for (std::string suffix : {"", ".gz", ".bgz"}) {
+                for (int threads : {1, 3}) {
+                    auto kMers = wrapper.kh_init_set();
+                    std::string compressedPath = path + suffix;
 
-            ReadKMers(kMers, wrapper, kmer_t (0), path, t.k, t.complements, t.case_sensitive);
+                    ReadKMers(kMers, wrapper, kmer_t(0), compressedPath, t.k, t.complements, t.case_sensitive, threads);
 
+                    EXPECT_EQ(t.wantResultSize, kh_size(kMers));
+                    wrapper.kh_destroy_set(kMers);
+                }
+            }
+        }
+
+    }
+
+    TEST(Parser, ShardBufferSize) {
+        // With few shards, the buffers are not shrunk.
+        EXPECT_EQ(SHARD_BUFFER_SIZE, ShardBufferSize<uint64_t>(8));
+        // With many shards, the buffers of a worker fit into the budget, however wide the k-mers are.
+        for (size_t threads : {16, 64, 256}) {
+            size_t shardsCount = threads * SHARDS_PER_THREAD;
+            EXPECT_LE(shardsCount * ShardBufferSize<uint64_t>(shardsCount) * sizeof(uint64_t), SHARD_BUFFERS_MEMORY);
+            EXPECT_LE(shardsCount * ShardBufferSize<kmer_t>(shardsCount) * sizeof(kmer_t), SHARD_BUFFERS_MEMORY);
+            EXPECT_LT(0, ShardBufferSize<kmer_t>(shardsCount));
+        }
+    }
+
+    TEST(Parser, ReadKMersSharded) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/test.fa";
+        for (int k : {2, 5, 10}) {
+            for (bool complements : {false, true}) {
+                auto kMers = wrapper.kh_init_set();
+                ReadKMers(kMers, wrapper, kmer_t (0), path, k, complements);
+                auto wantResult = kMersToVec(kMers, kmer_t(0));
+                std::sort(wantResult.begin(), wantResult.end());
+                for (int threads : {1, 2, 3}) {
+                    auto shards = ReadKMersSharded(wrapper, kmer_t(0), path, k, complements, threads);
+                    auto gotResult = kMersToVec(shards, kmer_t(0));
+                    std::sort(gotResult.begin(), gotResult.end());
+                    EXPECT_EQ(wantResult, gotResult);
+
+                    auto merged = MergeShards(shards, wrapper);
+                    EXPECT_EQ(wantResult.size(), kh_size(merged));
+                    wrapper.kh_destroy_set(merged);
+                }
+                wrapper.kh_destroy_set(kMers);
+            }
+        }
+    }
+
+    TEST(Parser, ReadKMersFromFiles) {
+        std::string directory = std::filesystem::current_path();
+        directory += "/tests/testdata/";
+        std::vector<std::string> paths = {directory + "test.fa", directory + "runstest.fa", directory + "test.fa.gz",
+                                          directory + "masktest.fa"};
+        for (int k : {2, 5, 10}) {
+            for (bool complements : {false, true}) {
+                auto kMers = wrapper.kh_init_set();
+                for (auto &&path : paths) ReadKMers(kMers, wrapper, kmer_t (0), path, k, complements);
+                auto wantResult = kMersToVec(kMers, kmer_t(0));
+                std::sort(wantResult.begin(), wantResult.end());
+                for (int threads : {1, 2, 8}) {
+                    auto shards = ReadKMersFromFiles(wrapper, kmer_t(0), paths, k, complements, threads);
+                    auto gotResult = kMersToVec(shards, kmer_t(0));
+                    std::sort(gotResult.begin(), gotResult.end());
+                    EXPECT_EQ(wantResult, gotResult);
+                    for (auto shard : shards) wrapper.kh_destroy_set(shard);
+                }
+                wrapper.kh_destroy_set(kMers);
+            }
+        }
+    }
+
+    TEST(Parser, ReadKMersSorted) {
+        std::string directory = std::filesystem::current_path();
+        directory += "/tests/testdata/";
+        for (std::vector<std::string> paths : std::vector<std::vector<std::string>>{
+                {directory + "test.fa"}, {directory + "test.fa.gz"}, {directory + "test.fa", directory + "runstest.fa"}}) {
+            for (int k : {2, 5, 10}) {
+                for (bool complements : {false, true}) {
+                    auto kMers = wrapper.kh_init_set();
+                    for (auto &&path : paths) ReadKMers(kMers, wrapper, kmer_t (0), path, k, complements);
+                    auto wantResult = kMersToVec(kMers, kmer_t(0));
+                    std::sort(wantResult.begin(), wantResult.end());
+                    wrapper.kh_destroy_set(kMers);
+                    for (int threads : {1, 3}) {
+                        auto gotResult = ReadKMersSorted(kmer_t(0), paths, k, complements, threads);
+
+                        EXPECT_EQ(wantResult, gotResult);
+                    }
+                }
+            }
+        }
+    }
+
+    TEST(Parser, ReadSolidKMers) {
+        struct TestCase {
+            int k;
+            bool complements;
+            int minCount;
+            size_t wantResultSize;
+        };
+        std::vector<TestCase> tests = {
+                {5, false, 1, 8},
+                {5, false, 2, 5},
+                {5, false, 3, 0},
+                // ACGTA and CGTAC are reverse complements of TACGT and GTACG.
+                {5, true, 1, 6},
+                {5, true, 2, 3},
+                {1, false, 6, 2},
+                {1, true, 13, 1},
+        };
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/reads.fq";
+        std::vector<std::string> paths = {path};
+
+        for (auto t : tests) {
+            auto kMers = ReadSolidKMers(wrapper, kmer_t(0), paths, t.k, t.complements, t.minCount);
             EXPECT_EQ(t.wantResultSize, kh_size(kMers));
+            wrapper.kh_destroy_set(kMers);
         }
+    }
+
+    TEST(Parser, ReadKMersFiltered) {
+        std::string path = std::filesystem::current_path();
+        path += "/tests/testdata/reads.fq";
+        std::vector<std::string> paths = {path};
+        for (int k : {1, 5}) {
+            for (bool complements : {false, true}) {
+                auto wantResult = ReadSolidKMers(wrapper, kmer_t(0), paths, k, complements, 2);
+                auto gotResult = ReadKMersFiltered(wrapper, kmer_t(0), paths, k, complements, 1 << 16);
 
+                // The filter is large enough to avoid false positives on the test data.
+                EXPECT_EQ(kh_size(wantResult), kh_size(gotResult));
+                for (auto i = kh_begin(wantResult); i != kh_end(wantResult); ++i) {
+                    if (!kh_exist(wantResult, i)) continue;
+                    EXPECT_NE(kh_end(gotResult), wrapper.kh_get_from_set(gotResult, kh_key(wantResult, i)));
+                }
+                wrapper.kh_destroy_set(wantResult);
+                wrapper.kh_destroy_set(gotResult);
+            }
+        }
     }
 #endif
 
+    TEST(Parser, CountKMers) {
+        std::string sequence(300, 'A');
+        sequence += "CCA";
+        auto counts = wrapper.kh_init_counter();
+
+        CountKMers(counts, wrapper, kmer_t(0), sequence.size(), sequence.data(), 2, false);
+
+        EXPECT_EQ(4, kh_size(counts));
+        for (auto i = kh_begin(counts); i != kh_end(counts); ++i) {
+            if (!kh_exist(counts, i)) continue;
+            // AA occurs 299 times, but the counter saturates.
+            if (kh_key(counts, i) == kmer_t(0)) EXPECT_EQ(UINT8_MAX, kh_val(counts, i));
+            else EXPECT_EQ(1, kh_val(counts, i));
+        }
+        wrapper.kh_destroy_counter(counts);
+    }
+
     TEST(Parser, AddKMersFromSequence) {
         struct TestCase {
             std::string data;
@@ -91,6 +244,39 @@ namespace {
         }
     }
 
+    TEST(Parser, ForEachKMerInRange) {
+        std::string data = ">1\nACCCGA\r\nAC\n>2 x\nCGTANATGC\n\n>3\nAcC\nCGT\nTTA\nACG\n>4\nA\n";
+        std::vector<std::string> sequences = {"ACCCGAAC", "CGTANATGC", "AcCCGTTTAACG", "A"};
+        for (int k : {1, 2, 3, 5}) {
+            for (bool case_sensitive : {false, true}) {
+                std::vector<kmer_t> wantResult;
+                for (auto &&sequence : sequences) {
+                    RollingKMer<kmer_t> state;
+                    ForEachKMer(state, sequence.size(), sequence.data(), k, false, case_sensitive,
+                                [&](kmer_t kMer) { wantResult.push_back(kMer); });
+                }
+                std::sort(wantResult.begin(), wantResult.end());
+                // Split the data at each pair of line starts.
+                std::vector<size_t> lineStarts = {0};
+                for (size_t i = 0; i < data.size(); ++i) if (data[i] == '\n') lineStarts.push_back(i + 1);
+                for (size_t i = 0; i < lineStarts.size(); ++i) {
+                    for (size_t j = i; j < lineStarts.size(); ++j) {
+                        std::vector<kmer_t> gotResult;
+                        for (auto [begin, end] : {std::make_pair(size_t(0), lineStarts[i]),
+                                                  std::make_pair(lineStarts[i], lineStarts[j]),
+                                                  std::make_pair(lineStarts[j], data.size())}) {
+                            ForEachKMerInRange(kmer_t(0), data.data(), data.size(), begin, end, k, false,
+                                               case_sensitive, [&](kmer_t kMer) { gotResult.push_back(kMer); });
+                        }
+                        std::sort(gotResult.begin(), gotResult.end());
+
+                        EXPECT_EQ(wantResult, gotResult);
+                    }
+                }
+            }
+        }
+    }
+
     TEST(Parser, FilterKMersWithComplement) {
         struct TestCase {
             std::unordered_set<std::string> kMers;
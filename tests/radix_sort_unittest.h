@@ -0,0 +1,47 @@
+#pragma once
+#include "../src/radix_sort.h"
+
+#include "kmer_types.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(RadixSort, RadixDigit) {
+        EXPECT_EQ(0b1011, RadixDigit(kmer_t(0b101101), 2, 4));
+        EXPECT_EQ(0b01, RadixDigit(kmer_t(0b101101), 0, 2));
+        EXPECT_EQ(0b10, RadixDigit(kmer_t(0b101101), 4, 8));
+    }
+
+    TEST(RadixSort, ParallelRadixSort) {
+        struct TestCase {
+            int k;
+            size_t size;
+        };
+        std::vector<TestCase> tests = {
+                {1, 100},
+                {3, 1000},
+                {5, 50},
+                {13, 100000},
+                {31, 20000},
+        };
+        std::mt19937_64 random(42);
+
+        for (auto &t : tests) {
+            kmer_t mask = (kmer_t(1) << (2 * t.k)) - kmer_t(1);
+            for (int threads : {1, 3}) {
+                std::vector<kmer_t> kMers(t.size);
+                for (auto &&kMer : kMers) kMer = ((kmer_t(random()) << 32) ^ kmer_t(random())) & mask;
+                auto wantResult = kMers;
+                std::sort(wantResult.begin(), wantResult.end());
+
+                ParallelRadixSort(kMers, t.k, threads);
+
+                EXPECT_EQ(wantResult, kMers);
+            }
+        }
+    }
+}
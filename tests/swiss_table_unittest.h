@@ -0,0 +1,138 @@
+#pragma once
+#include "../src/swiss_table.h"
+#include "../src/global.h"
+#include "../src/local.h"
+#include "../src/parser.h"
+
+#include "kmer_types.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+
+#include "gtest/gtest.h"
+
+namespace {
+    TEST(SwissTable, SetOperations) {
+        swiss_dict_t<kmer_t> swissWrapper;
+        auto *kMers = swissWrapper.kh_init_set();
+        auto *want = wrapper.kh_init_set();
+        // Insert and erase k-mers so that both growing and DELETED slots are exercised.
+        for (size_t i = 0; i < 20000; ++i) {
+            kmer_t kMer = kmer_t(MixHash(i % 7919));
+            int ret, wantRet;
+            if (i % 3 == 2) {
+                auto key = swissWrapper.kh_get_from_set(kMers, kMer);
+                auto wantKey = wrapper.kh_get_from_set(want, kMer);
+                EXPECT_EQ(wantKey == kh_end(want), key == kh_end(kMers));
+                if (key != kh_end(kMers)) swissWrapper.kh_del_from_set(kMers, key);
+                if (wantKey != kh_end(want)) wrapper.kh_del_from_set(want, wantKey);
+            } else {
+                auto key = swissWrapper.kh_put_to_set(kMers, kMer, &ret);
+                wrapper.kh_put_to_set(want, kMer, &wantRet);
+                EXPECT_EQ(bool(wantRet), bool(ret));
+                EXPECT_EQ(kMer, kh_key(kMers, key));
+            }
+            EXPECT_EQ(kh_size(want), kh_size(kMers));
+        }
+        size_t lastIndex = 0, iterated = 0;
+        for (kmer_t kMer; nextKMer(kMers, kMer, lastIndex); ++lastIndex) {
+            EXPECT_NE(kh_end(want), wrapper.kh_get_from_set(want, kMer));
+            ++iterated;
+        }
+        EXPECT_EQ(kh_size(want), iterated);
+        swissWrapper.kh_destroy_set(kMers);
+        wrapper.kh_destroy_set(want);
+    }
+
+    TEST(SwissTable, ReadKMers) {
+        std::string directory = std::filesystem::current_path();
+        directory += "/tests/testdata/";
+        std::vector<std::string> paths = {directory + "test.fa", directory + "runstest.fa"};
+        swiss_dict_t<kmer_t> swissWrapper;
+        auto toSortedVec = [](auto &&shards) {
+            std::vector<kmer_t> result;
+            for (auto shard : shards) {
+                size_t lastIndex = 0;
+                for (kmer_t kMer; nextKMer(shard, kMer, lastIndex); ++lastIndex) result.push_back(kMer);
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        };
+        for (int k : {5, 10}) {
+            for (bool complements : {false, true}) {
+                auto want = wrapper.kh_init_set();
+                for (auto &&path : paths) ReadKMers(want, wrapper, kmer_t(0), path, k, complements);
+                auto wantResult = kMersToVec(want, kmer_t(0));
+                std::sort(wantResult.begin(), wantResult.end());
+                for (int threads : {1, 3}) {
+                    auto shards = ReadKMersFromFiles(swissWrapper, kmer_t(0), paths, k, complements, threads);
+                    EXPECT_EQ(wantResult, toSortedVec(shards));
+                    auto merged = MergeShards(shards, swissWrapper);
+                    EXPECT_EQ(wantResult, toSortedVec(std::vector{merged}));
+                    swissWrapper.kh_destroy_set(merged);
+                }
+                auto solid = ReadSolidKMers(wrapper, swissWrapper, kmer_t(0), paths, k, complements, 1);
+                EXPECT_EQ(wantResult, toSortedVec(std::vector{solid}));
+                swissWrapper.kh_destroy_set(solid);
+                wrapper.kh_destroy_set(want);
+            }
+        }
+    }
+
+    TEST(SwissTable, MapOperations) {
+        swiss_dict_t<kmer_t> swissWrapper;
+        auto *map = swissWrapper.kh_init_map();
+        swissWrapper.kh_resize_map(map, 100);
+        EXPECT_EQ(128, kh_end(map));
+        for (size_t i = 0; i < 1000; ++i) {
+            int ret;
+            auto key = swissWrapper.kh_put_to_map(map, kmer_t(i), &ret);
+            EXPECT_EQ(1, ret);
+            kh_value(map, key) = 2 * i;
+        }
+        for (size_t i = 0; i < 2000; ++i) {
+            auto key = swissWrapper.kh_get_from_map(map, kmer_t(i));
+            if (i < 1000) {
+                ASSERT_NE(kh_end(map), key);
+                EXPECT_EQ(2 * i, kh_val(map, key));
+            } else {
+                EXPECT_EQ(kh_end(map), key);
+            }
+        }
+        auto buckets = kh_end(map);
+        swissWrapper.kh_clear_map(map);
+        EXPECT_EQ(0, kh_size(map));
+        EXPECT_EQ(buckets, kh_end(map));
+        EXPECT_EQ(kh_end(map), swissWrapper.kh_get_from_map(map, kmer_t(1)));
+        swissWrapper.kh_destroy_map(map);
+    }
+
+    TEST(SwissTable, Global) {
+        std::vector<std::pair<std::vector<kmer_t>, bool>> tests = {
+                {{KMerToNumber({"ACG"}), KMerToNumber({"CGT"}), KMerToNumber({"TAA"}), KMerToNumber({"GTT"})}, false},
+                {{KMerToNumber({"ACG"}), KMerToNumber({"TAA"}), KMerToNumber({"GTT"})}, true},
+                {{KMerToNumber({"GCT"}), KMerToNumber({"TAA"}), KMerToNumber({"AAA"})}, false},
+        };
+        for (auto &[kMers, complements] : tests) {
+            std::stringstream want, got;
+            auto kMersCopy = kMers;
+            Global(wrapper, kMers, want, 3, complements);
+            Global(swiss_dict_t<kmer_t>(), kMersCopy, got, 3, complements);
+            EXPECT_EQ(want.str(), got.str());
+        }
+    }
+
+    TEST(SwissTable, Local) {
+        swiss_dict_t<kmer_t> swissWrapper;
+        auto *kMers = swissWrapper.kh_init_set();
+        int ret;
+        for (auto &&kMer : {"GTT", "ACG", "TGC", "CGT", "GCA", "TTG"}) swissWrapper.kh_put_to_set(kMers, KMerToNumber({kMer}), &ret);
+        std::stringstream of;
+        // A single path gives the same superstring regardless of the iteration order.
+        Local(kMers, swissWrapper, kmer_t(0), of, 3, 2, false);
+        EXPECT_EQ("ACGTTGca", of.str());
+        EXPECT_EQ(0, kh_size(kMers));
+        swissWrapper.kh_destroy_set(kMers);
+    }
+}
@@ -8,6 +8,23 @@
 #include "ac_automaton_unittest.h"
 #include "lower_bound_unittest.h"
 #include "masks_unittest.h"
+#include "parallel_unittest.h"
+#include "bgzf_unittest.h"
+#include "encoding_unittest.h"
+#include "external_unittest.h"
+#include "kmer_set_unittest.h"
+#include "bloom_unittest.h"
+#include "async_reader_unittest.h"
+#include "radix_sort_unittest.h"
+#include "compact_set_unittest.h"
+#include "concurrent_set_unittest.h"
+#include "swiss_table_unittest.h"
+#include "khash_utils_unittest.h"
+#include "kmer_words_unittest.h"
+#include "kmer256_unittest.h"
+#include "packed_array_unittest.h"
+#include "hyperloglog_unittest.h"
+#include "checkpoint_unittest.h"
 
 #include "gtest/gtest.h"
 